@@ -0,0 +1,32 @@
+# 将目录中的静态资源编译进程序：生成包含资源表的头文件，并加入目标的包含路径
+#
+#   saxio_embed_assets(<target> <name> DIRECTORY <dir> [PATTERNS <glob>...])
+#
+# 生成 saxio_assets/<name>.hpp，其中 saxio::assets::<name>::table 是
+# saxio::http::EmbeddedAsset 数组，可直接传给 RequestHandler::mount_embedded()。
+# 目录中的文件变化后重新生成（新增文件需要重新运行 CMake）。
+set(SAXIO_EMBED_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/embed_assets.cmake)
+
+function(saxio_embed_assets target name)
+    cmake_parse_arguments(ARG "" "DIRECTORY" "PATTERNS" ${ARGN})
+    if (NOT ARG_PATTERNS)
+        set(ARG_PATTERNS "*")
+    endif()
+
+    set(globs)
+    foreach (pattern ${ARG_PATTERNS})
+        list(APPEND globs ${ARG_DIRECTORY}/${pattern})
+    endforeach()
+    file(GLOB_RECURSE files LIST_DIRECTORIES false ${globs})
+
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/saxio_assets/${name}.hpp)
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND ${CMAKE_COMMAND} -DNAME=${name} -DDIRECTORY=${ARG_DIRECTORY}
+                "-DFILES=${files}" -DOUTPUT=${output} -P ${SAXIO_EMBED_SCRIPT}
+        DEPENDS ${files} ${SAXIO_EMBED_SCRIPT}
+        COMMENT "Embedding assets ${name} from ${ARG_DIRECTORY}"
+        VERBATIM)
+    target_sources(${target} PRIVATE ${output})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
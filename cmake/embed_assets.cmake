@@ -0,0 +1,52 @@
+# 由 saxio_embed_assets() 在构建时调用：cmake -DNAME= -DDIRECTORY= -DFILES= -DOUTPUT= -P embed_assets.cmake
+# 每个文件生成一个十六进制转义的字符串字面量，编译器处理字符串字面量比处理大数组初始化列表快得多
+
+function(mime_type_of path out)
+    get_filename_component(ext ${path} LAST_EXT)
+    string(TOLOWER "${ext}" ext)
+    set(types
+        .html text/html .htm text/html .css text/css .txt text/plain .md text/markdown
+        .js application/javascript .mjs application/javascript .json application/json
+        .svg image/svg+xml .png image/png .jpg image/jpeg .jpeg image/jpeg .gif image/gif
+        .webp image/webp .ico image/x-icon .wasm application/wasm
+        .woff font/woff .woff2 font/woff2 .ttf font/ttf)
+    list(FIND types "${ext}" index)
+    if (index EQUAL -1 OR ext STREQUAL "")
+        set(${out} application/octet-stream PARENT_SCOPE)
+    else()
+        math(EXPR index "${index} + 1")
+        list(GET types ${index} type)
+        set(${out} ${type} PARENT_SCOPE)
+    endif()
+endfunction()
+
+set(entries "")
+list(SORT FILES)
+foreach (file ${FILES})
+    file(RELATIVE_PATH relative ${DIRECTORY} ${file})
+    file(SIZE ${file} size)
+    file(SHA1 ${file} sha1)
+    string(SUBSTRING ${sha1} 0 16 etag)
+    mime_type_of(${file} mime)
+
+    # 每 64 字节一行：\xNN 转义后按行拆成相邻的字符串字面量
+    file(READ ${file} hex HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" escaped "${hex}")
+    string(REGEX REPLACE "((\\\\x[0-9a-f][0-9a-f]){64})" "\\1\"\n        \"" escaped "${escaped}")
+
+    string(APPEND entries
+        "    {\"/${relative}\", \"${mime}\", \"\\\"${etag}-${size}\\\"\",\n"
+        "     std::string_view{\n        \"${escaped}\", ${size}}},\n")
+endforeach()
+
+file(WRITE ${OUTPUT}.tmp
+    "// 由 saxio_embed_assets() 生成，请勿手动修改\n"
+    "#pragma once\n\n"
+    "#include \"saxio/net/http/embedded_assets.hpp\"\n\n"
+    "namespace saxio::assets::${NAME}{\n\n"
+    "inline constexpr saxio::http::EmbeddedAsset table[] = {\n"
+    "${entries}"
+    "};\n\n"
+    "}\n")
+file(COPY_FILE ${OUTPUT}.tmp ${OUTPUT} ONLY_IF_DIFFERENT)
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,254 @@
+#pragma once
+#include "saxio/common/error.hpp"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+
+namespace saxio::net
+{
+
+//CPU 集合，对 cpu_set_t 的简单封装
+class CpuSet {
+public:
+    CpuSet(){ CPU_ZERO(&set_); }
+
+    CpuSet(std::initializer_list<int> cpus) : CpuSet(){
+        for (int cpu : cpus) add(cpu);
+    }
+
+    //解析内核的 cpulist 格式，例如 "0-3,8,10-11"；格式错误的部分被忽略
+    static auto parse(std::string_view list) -> CpuSet{
+        CpuSet set;
+        while (!list.empty()) {
+            auto comma = list.find(',');
+            auto item = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            int first = 0, last = 0;
+            auto [p, ec] = std::from_chars(item.data(), item.data() + item.size(), first);
+            if (ec != std::errc{}) continue;
+            last = first;
+            if (p != item.data() + item.size() && *p == '-') {
+                if (std::from_chars(p + 1, item.data() + item.size(), last).ec != std::errc{}) continue;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) set.add(cpu);
+        }
+        return set;
+    }
+
+    //当前进程允许运行的 CPU（受 taskset、cgroup cpuset 限制）
+    static auto allowed() -> CpuSet{
+        CpuSet set;
+        if (::sched_getaffinity(0, sizeof(set.set_), &set.set_) != 0) {
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+                set.add(static_cast<int>(cpu));
+            }
+        }
+        return set;
+    }
+
+    auto add(int cpu) -> void{
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set_);
+    }
+
+    [[nodiscard]]
+    auto contains(int cpu) const -> bool{
+        return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &set_);
+    }
+
+    [[nodiscard]]
+    auto count() const -> size_t{ return static_cast<size_t>(CPU_COUNT(&set_)); }
+
+    [[nodiscard]]
+    auto empty() const -> bool{ return count() == 0; }
+
+    //集合中的 CPU 编号，从小到大
+    [[nodiscard]]
+    auto cpus() const -> std::vector<int>{
+        std::vector<int> result;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set_)) result.push_back(cpu);
+        }
+        return result;
+    }
+
+    //交集
+    auto operator&(const CpuSet& other) const -> CpuSet{
+        CpuSet result;
+        CPU_AND(&result.set_, &set_, &other.set_);
+        return result;
+    }
+
+    [[nodiscard]]
+    auto native() const -> const cpu_set_t&{ return set_; }
+
+private:
+    cpu_set_t set_;
+};
+
+//一个 NUMA 节点及其 CPU
+struct NumaNode {
+    int id;
+    CpuSet cpus;
+};
+
+namespace detail {
+
+inline auto load_numa_nodes() -> std::vector<NumaNode>{
+    CpuSet allowed = CpuSet::allowed();
+    std::vector<NumaNode> nodes;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        int id = 0;
+        if (!name.starts_with("node") ||
+            std::from_chars(name.data() + 4, name.data() + name.size(), id).ptr != name.data() + name.size()) {
+            continue;
+        }
+        std::ifstream file(entry.path() / "cpulist");
+        std::string list;
+        if (!std::getline(file, list)) continue;
+
+        CpuSet cpus = CpuSet::parse(list) & allowed;
+        if (!cpus.empty()) {
+            nodes.push_back({id, cpus});
+        }
+    }
+
+    if (nodes.empty()) {
+        nodes.push_back({0, allowed});
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    return nodes;
+}
+
+} // namespace detail
+
+//NUMA 拓扑，从 /sys 读取（不依赖 libnuma），只包含当前进程允许使用的 CPU；
+//读不到拓扑时（非 NUMA 内核、容器中 /sys 不完整）把所有允许的 CPU 当作节点 0
+inline auto numa_nodes() -> const std::vector<NumaNode>&{
+    static const std::vector<NumaNode> nodes = detail::load_numa_nodes();
+    return nodes;
+}
+
+//CPU 所在的 NUMA 节点，未知时返回 -1
+inline auto numa_node_of(int cpu) -> int{
+    for (const auto& node : numa_nodes()) {
+        if (node.cpus.contains(cpu)) return node.id;
+    }
+    return -1;
+}
+
+//与该 CPU 同一 NUMA 节点的全部可用 CPU；CPU 未知时返回所有可用 CPU
+inline auto node_cpus(int cpu) -> CpuSet{
+    for (const auto& node : numa_nodes()) {
+        if (node.cpus.contains(cpu)) return node.cpus;
+    }
+    return CpuSet::allowed();
+}
+
+//为 count 个线程各分配一个 CPU：按 NUMA 节点顺序排列所有可用 CPU 后依次分配，线程多于 CPU 时循环使用。
+//编号相邻的线程落在同一节点上，共享末级缓存与本地内存
+inline auto spread_cpus(size_t count) -> std::vector<CpuSet>{
+    std::vector<int> order;
+    for (const auto& node : numa_nodes()) {
+        for (int cpu : node.cpus.cpus()) order.push_back(cpu);
+    }
+    std::vector<CpuSet> result;
+    if (order.empty()) return result;
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(CpuSet{order[i % order.size()]});
+    }
+    return result;
+}
+
+//把当前线程绑定到给定的 CPU 集合；此后线程首次访问的内存由内核分配在这些 CPU 的本地节点上
+inline auto pin_current_thread(const CpuSet& cpus) -> Result<void>{
+    if (cpus.empty() || ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &cpus.native()) != 0) {
+        return std::unexpected{make_error(Error::kSetAffinityFailed)};
+    }
+    return {};
+}
+
+//当前线程正在运行的 CPU，未知时返回 -1
+inline auto current_cpu() -> int{
+    return ::sched_getcpu();
+}
+
+//内核处理该连接收包的 CPU（SO_INCOMING_CPU，一般就是网卡 RX 队列中断所在的 CPU），未知时返回 -1
+inline auto incoming_cpu(int fd) -> int{
+#ifdef SO_INCOMING_CPU
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (::getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == 0) {
+        return cpu;
+    }
+#endif
+    return -1;
+}
+
+//连接处理线程的 CPU 亲和性策略，由服务器在连接线程开始处理连接时应用
+class ConnectionAffinity {
+public:
+    enum class Policy {
+        kNone,          //不绑定（默认）
+        kIncomingNode,  //绑定到收包 CPU 所在 NUMA 节点的全部 CPU
+        kCpuSets,       //绑定到给定集合之一：优先选包含收包 CPU 的集合，否则按描述符轮流分配
+    };
+
+    ConnectionAffinity() = default;
+
+    static auto incoming_node() -> ConnectionAffinity{
+        ConnectionAffinity affinity;
+        affinity.policy_ = Policy::kIncomingNode;
+        return affinity;
+    }
+
+    static auto cpu_sets(std::vector<CpuSet> sets) -> ConnectionAffinity{
+        ConnectionAffinity affinity;
+        if (!sets.empty()) {
+            affinity.policy_ = Policy::kCpuSets;
+            affinity.sets_ = std::move(sets);
+        }
+        return affinity;
+    }
+
+    [[nodiscard]]
+    auto policy() const -> Policy{ return policy_; }
+
+    /**
+     * @brief 在处理连接的线程中调用，按策略绑定当前线程；之后分配的缓冲区落在对应节点的本地内存
+     * @param fd 连接的套接字，用于读取收包 CPU
+     * @return 不需要绑定或收包 CPU 未知时直接成功，绑定失败时返回 kSetAffinityFailed
+     */
+    auto apply(int fd) const -> Result<void>{
+        if (policy_ == Policy::kNone) {
+            return {};
+        }
+        int cpu = incoming_cpu(fd);
+        if (policy_ == Policy::kIncomingNode) {
+            return cpu < 0 ? Result<void>{} : pin_current_thread(node_cpus(cpu));
+        }
+        for (const auto& set : sets_) {
+            if (set.contains(cpu)) return pin_current_thread(set);
+        }
+        return pin_current_thread(sets_[static_cast<size_t>(fd) % sets_.size()]);
+    }
+
+private:
+    Policy policy_{Policy::kNone};
+    std::vector<CpuSet> sets_;
+};
+
+}// namespace saxio
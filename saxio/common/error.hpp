@@ -25,6 +25,20 @@ namespace saxio
             kClientConnectFailed,
             kSetNonBlockFailed,   //设置非阻塞I/O错误
             kSendResponseFailed,  //服务端向客户端发送响应失败
+            kHttpBadRequest,      //HTTP请求格式错误
+            kHttpBodyTooLarge,    //HTTP请求体超过上限
+            kHttpMalformedChunk,  //chunked 编码格式错误
+            kWebSocketProtocolError,  //WebSocket 帧不符合协议
+            kWebSocketClosed,     //WebSocket 连接已关闭
+            kTimeout,             //操作超时
+            kResolveFailed,       //域名解析失败
+            kHttpBadUrl,          //不支持或格式错误的 URL
+            kHttpBadResponse,     //HTTP响应格式错误
+            kForkFailed,          //创建子进程失败
+            kFdPassingFailed,     //通过 UNIX 套接字传递文件描述符失败
+            kRPCDeadlineExceeded, //RPC 调用超过截止时间
+            kRPCCancelled,        //RPC 调用已被取消
+            kSetAffinityFailed,   //设置线程 CPU 亲和性失败
         };
 
     public:
@@ -64,6 +78,34 @@ namespace saxio
                     return "Set non-block failed";
                 case kSendResponseFailed:
                     return "Send response failed";
+                case kHttpBadRequest:
+                    return "Bad HTTP request";
+                case kHttpBodyTooLarge:
+                    return "HTTP body too large";
+                case kHttpMalformedChunk:
+                    return "Malformed chunked body";
+                case kWebSocketProtocolError:
+                    return "WebSocket protocol error";
+                case kWebSocketClosed:
+                    return "WebSocket connection closed";
+                case kTimeout:
+                    return "Operation timed out";
+                case kResolveFailed:
+                    return "Resolve host failed";
+                case kHttpBadUrl:
+                    return "Bad URL";
+                case kHttpBadResponse:
+                    return "Bad HTTP response";
+                case kForkFailed:
+                    return "Fork failed";
+                case kFdPassingFailed:
+                    return "File descriptor passing failed";
+                case kRPCDeadlineExceeded:
+                    return "RPC deadline exceeded";
+                case kRPCCancelled:
+                    return "RPC call cancelled";
+                case kSetAffinityFailed:
+                    return "Set CPU affinity failed";
                 default:
                     //将错误码转换为可读的错误信息字符串
                     return strerror(error_code_);
@@ -0,0 +1,223 @@
+#pragma once
+#include "saxio/common/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+
+namespace saxio::net
+{
+
+//结构化的任务组：run() 提交的任务都在 wait() 返回前完成
+//
+//任务可以在组内继续 run() 新任务。线程池队列已满时任务在调用线程直接执行。
+//在工作线程中等待时先帮忙执行等待中的任务，嵌套使用不会把线程池的线程全部阻塞。
+//组内任务抛出的第一个异常在 wait() 中重新抛出，析构时只等待不抛出。
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool){}
+
+    TaskGroup(const TaskGroup&) = delete;
+    auto operator=(const TaskGroup&) -> TaskGroup& = delete;
+
+    ~TaskGroup(){ wait_all(); }
+
+    //提交一个属于本组的任务
+    template <typename F>
+    auto run(F&& task) -> void{
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++count_;
+        }
+        auto job = [this, fn = std::forward<F>(task)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            finish();
+        };
+        if (!pool_.enqueue(std::move(job))) {
+            job();
+        }
+    }
+
+    //等待组内所有任务完成
+    auto wait() -> void{
+        wait_all();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    auto finish() -> void{
+        //持有锁通知：等待者拿到锁之前不会返回，也就不会在通知期间销毁任务组
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--count_ == 0) {
+            done_.notify_all();
+        }
+    }
+
+    auto wait_all() -> void{
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (count_ == 0) return;
+            }
+            if (!pool_.run_pending_task()) break;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return count_ == 0; });
+    }
+
+    ThreadPool& pool_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    size_t count_{0};               //已提交未完成的任务数
+    std::exception_ptr error_;      //第一个失败任务的异常
+};
+
+namespace detail {
+
+//并行循环的共享状态：各参与者从 next 处领取一段区间，直到取完
+//
+//每次领取剩余量的 1/(2*参与者数)，不少于 grain：开始时块大、争用少，接近结尾时块变小，
+//先完成的线程还能分到活，执行快慢不均时也能把负载摊平。
+struct LoopState {
+    LoopState(size_t begin, size_t end, size_t grain, size_t participants)
+        : next(begin), end(end), grain(grain), participants(participants){}
+
+    auto grab(size_t& first, size_t& last) -> bool{
+        size_t cur = next.load(std::memory_order_relaxed);
+        while (cur < end) {
+            size_t chunk = std::max(grain, (end - cur) / (2 * participants));
+            size_t stop = end - cur <= chunk ? end : cur + chunk;
+            if (next.compare_exchange_weak(cur, stop, std::memory_order_relaxed)) {
+                first = cur;
+                last = stop;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::atomic<size_t> next;
+    const size_t end;
+    const size_t grain;
+    const size_t participants;
+
+    std::atomic<size_t> active{0};  //正在领取或执行区间的参与者数
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::exception_ptr error;
+};
+
+//在线程池与调用线程上并行执行 participant(state)，返回前所有领到区间的参与者都已结束
+//
+//辅助任务持有共享状态，先登记为活跃再检查是否还有区间：调用者看到活跃数为 0 之后才开始的
+//辅助任务一定看到区间已经取完，直接返回，不会访问调用者栈上的对象。
+//调用者因此只需要等正在执行的参与者，不必等还在排队的辅助任务。
+template <typename Participant>
+auto run_loop(ThreadPool& pool, size_t begin, size_t end, size_t grain, Participant& participant) -> void{
+    size_t chunks = (end - begin + grain - 1) / grain;
+    size_t helpers = std::min(pool.size(), chunks - 1);
+    auto state = std::make_shared<LoopState>(begin, end, grain, helpers + 1);
+
+    auto work = [state, &participant] {
+        state->active.fetch_add(1, std::memory_order_seq_cst);
+        try {
+            if (state->next.load(std::memory_order_seq_cst) < state->end) {
+                participant(*state);
+            }
+        } catch (...) {
+            //停止分配新的区间
+            state->next.store(state->end, std::memory_order_seq_cst);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->error) state->error = std::current_exception();
+        }
+        if (state->active.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->idle.notify_all();
+        }
+    };
+    for (size_t i = 0; i < helpers; ++i) {
+        if (!pool.enqueue(work)) break;
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->idle.wait(lock, [&] { return state->active.load(std::memory_order_seq_cst) == 0; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief 并行执行 body(first, last)，各区间不重叠且合起来正好覆盖 [begin, end)
+ * @param pool 线程池，调用线程也参与执行
+ * @param body 处理一段区间的函数，按区间调用便于在内部做向量化
+ * @param grain 每段区间的最小长度，body 开销很小时应适当调大
+ */
+template <typename Body>
+auto parallel_for(ThreadPool& pool, size_t begin, size_t end, Body&& body, size_t grain = 1) -> void{
+    grain = std::max<size_t>(grain, 1);
+    if (end <= begin) return;
+    if (end - begin <= grain || pool.size() == 0) {
+        body(begin, end);
+        return;
+    }
+
+    auto participant = [&body](detail::LoopState& state) {
+        size_t first, last;
+        while (state.grab(first, last)) {
+            body(first, last);
+        }
+    };
+    detail::run_loop(pool, begin, end, grain, participant);
+}
+
+/**
+ * @brief 并行归约：每个参与者先在本地合并自己领到的区间，最后再合并各参与者的结果
+ * @param identity 归约的单位元，每个参与者都从它开始
+ * @param body 计算一段区间 [first, last) 的部分结果
+ * @param combine 合并两个部分结果，必须满足结合律与交换律（合并顺序不确定）
+ * @param grain 每段区间的最小长度
+ * @return 所有区间结果合并后的值
+ */
+template <typename T, typename Body, typename Combine>
+auto parallel_reduce(ThreadPool& pool, size_t begin, size_t end, T identity,
+                     Body&& body, Combine&& combine, size_t grain = 1) -> T{
+    grain = std::max<size_t>(grain, 1);
+    if (end <= begin) return identity;
+    if (end - begin <= grain || pool.size() == 0) {
+        return combine(std::move(identity), body(begin, end));
+    }
+
+    T result = identity;
+    std::mutex result_mutex;
+    auto participant = [&](detail::LoopState& state) {
+        T local = identity;
+        size_t first, last;
+        bool any = false;
+        while (state.grab(first, last)) {
+            local = combine(std::move(local), body(first, last));
+            any = true;
+        }
+        if (any) {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result = combine(std::move(result), std::move(local));
+        }
+    };
+    detail::run_loop(pool, begin, end, grain, participant);
+    return result;
+}
+
+}// namespace saxio
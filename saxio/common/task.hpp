@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace saxio::net
+{
+
+//只能移动的任务，替代 std::function<void()> 提交到线程池
+//
+//可调用对象不需要可复制，因此 lambda 可以直接按值捕获 TcpStream 等只能移动的资源；
+//不超过 kInlineSize 字节且移动不抛异常的可调用对象直接存放在内部缓冲区，不分配堆内存，
+//更大的可调用对象退回堆上。
+class Task {
+public:
+    static constexpr size_t kInlineSize = 48;   //足以放下捕获几个指针或一个连接对象的 lambda
+
+    Task() noexcept = default;
+
+    //不加 explicit，lambda 可以直接传给接受 Task 的接口
+    template <typename F>
+        requires (!std::is_same_v<std::decay_t<F>, Task> && std::is_invocable_v<std::decay_t<F>&>)
+    Task(F&& f){
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>()) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &inline_ops<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(f));
+            ops_ = &heap_ops<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept{
+        take(other);
+    }
+
+    auto operator=(Task&& other) noexcept -> Task&{
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    auto operator=(const Task&) -> Task& = delete;
+
+    ~Task(){ reset(); }
+
+    //执行任务，任务必须非空
+    auto operator()() -> void{ ops_->invoke(storage_); }
+
+    explicit operator bool() const noexcept{ return ops_ != nullptr; }
+
+    //销毁持有的可调用对象（同时释放它捕获的资源）
+    auto reset() noexcept -> void{
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src) noexcept;    //移动到 dst 并销毁 src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr auto fits_inline() -> bool{
+        return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops inline_ops{
+        [](void* storage) { (*std::launder(static_cast<Fn*>(storage)))(); },
+        [](void* dst, void* src) noexcept {
+            Fn* from = std::launder(static_cast<Fn*>(src));
+            ::new (dst) Fn(std::move(*from));
+            from->~Fn();
+        },
+        [](void* storage) noexcept { std::launder(static_cast<Fn*>(storage))->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops heap_ops{
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+        [](void* storage) noexcept { delete *static_cast<Fn**>(storage); },
+    };
+
+    auto take(Task& other) noexcept -> void{
+        if (other.ops_) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_{nullptr};
+};
+
+}// namespace saxio
@@ -1,95 +1,751 @@
 #pragma once
+#include "saxio/common/task.hpp"
+#include "saxio/common/affinity.hpp"
+#include "saxio/common/debug.hpp"
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
+#include <memory>
 #include <functional>
-#include <condition_variable>
+#include <semaphore>
+#include <latch>
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <variant>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 
 namespace saxio::net
 {
 
+namespace detail {
+
+inline auto cpu_relax() -> void{
+#if defined(__SSE2__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+//Vyukov 有界多生产者多消费者环形队列
+//每个槽位带一个序号，生产者和消费者各自用 CAS 抢占位置后只写自己的槽位，不需要锁；
+//槽位按缓存行对齐，相邻位置的生产者与消费者不会互相使缓存行失效
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          slots_(std::make_unique<Slot[]>(mask_ + 1)){
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //队列已满返回 false
+    auto push(T value) -> bool{
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //队列为空返回 false
+    auto pop(T& value) -> bool{
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        T value{};
+    };
+
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+};
+
+//Chase-Lev 工作窃取双端队列（固定容量）
+//所有者线程在底部 push/pop（LIFO），其他线程从顶部 steal（FIFO），只有争抢最后一个元素时才需要 CAS
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          buffer_(std::make_unique<std::atomic<T*>[]>(mask_ + 1)){}
+
+    //仅所有者线程调用，队列已满返回 false
+    auto push(T* item) -> bool{
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(mask_)) {
+            return false;
+        }
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    //仅所有者线程调用，取出最近压入的元素
+    auto pop() -> T*{
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            //只剩一个元素，与窃取者竞争
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    //任意线程调用，取出最早压入的元素；队列为空或竞争失败返回 nullptr
+    auto steal() -> T*{
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{0};       //窃取端，被其他线程修改
+    alignas(64) std::atomic<int64_t> bottom_{0};    //所有者端
+    size_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> buffer_;
+};
+
+//submit() 的结果：任务完成时写入一次，由 Future 读取
+template <typename T>
+struct FutureState {
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    std::atomic<bool> ready{false};
+    std::optional<Value> value;
+    std::exception_ptr error;
+
+    template <typename F>
+    auto run(F& f) -> void{
+        try {
+            if constexpr (std::is_void_v<T>) {
+                f();
+                value.emplace();
+            } else {
+                value.emplace(f());
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        ready.store(true, std::memory_order_release);
+        ready.notify_all();
+    }
+};
+
+} // namespace detail
+
+class ThreadPool;
+
+//submit() 返回的轻量 future：结果与就绪标志放在同一块共享状态中，等待用原子变量的 wait/notify，
+//不需要 std::promise 的互斥锁与条件变量。在线程池的工作线程中等待时会先帮忙执行其他任务。
+template <typename T>
+class Future {
+public:
+    Future() = default;
+
+    //结果是否已经就绪
+    [[nodiscard]]
+    auto ready() const -> bool{ return state_->ready.load(std::memory_order_acquire); }
+
+    //等待任务完成
+    auto wait() const -> void;
+
+    //等待并取出结果，任务抛出的异常在这里重新抛出；只能调用一次
+    auto get() -> T{
+        wait();
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*state_->value);
+        }
+    }
+
+    [[nodiscard]]
+    auto valid() const -> bool{ return state_ != nullptr; }
+
+private:
+    friend class ThreadPool;
+
+    Future(ThreadPool* pool, std::shared_ptr<detail::FutureState<T>> state)
+        : pool_(pool), state_(std::move(state)){}
+
+    ThreadPool* pool_{nullptr};
+    std::shared_ptr<detail::FutureState<T>> state_;
+};
+
+//工作窃取线程池
+//
+//每个工作线程有自己的 Chase-Lev 双端队列：工作线程内提交的任务压入本地队列，按 LIFO 执行以利用缓存，
+//空闲的线程从其他队列顶部按 FIFO 窃取；外部线程提交的任务进入全局注入队列。
+//空闲线程各自休眠在独立的信号量上，提交任务时最多唤醒一个；已有线程正在寻找任务时不再唤醒新的，
+//找到任务的寻找者再接力唤醒下一个，避免惊群。多核机器上线程休眠前先自旋一小段时间。
+//
+//任务节点从预先分配的节点池中循环使用，提交小任务不分配内存。
+//全局队列默认是互斥锁保护的环形缓冲区；生产者很多（例如多个 accept 线程）时可以选择无锁的
+//MPMC 环形队列，此时等待任务数上限同时也是环的容量（最多 kMaxRingCapacity）。
+//
+//可以把工作线程绑定到指定的 CPU 上：线程先绑定 CPU 再分配自己的队列，内存按首次访问落在本地 NUMA 节点。
+//每个工作线程还有一个收件箱，enqueue_to() 把任务交给指定线程（例如与连接收包 CPU 相同的线程），
+//该线程忙时其他线程在本地队列都窃取不到任务后才会从收件箱中窃取。
 class ThreadPool {
 public:
+    //全局注入队列的实现
+    enum class QueueMode {
+        kMutex,       //互斥锁 + 可扩容的环形缓冲区
+        kLockFree,    //无锁有界环形队列
+    };
+
     /**
      * @brief 创建指定数量的工作线程
      * @param num_threads 工作线程数量
      * @param max_pending 最大等待任务数，用于控制并发连接数
+     * @param mode 全局队列的实现
+     * @param affinity 工作线程绑定的 CPU 集合，第 i 个线程使用 affinity[i % affinity.size()]；为空时不绑定
+     *                 （可用 spread_cpus(num_threads) 按 NUMA 节点均匀分配）
      */
-    explicit ThreadPool(size_t num_threads, size_t max_pending = 100) :
-        max_pending_tasks_(max_pending), stop_(false){
-        //创建指定数量的工作线程
+    explicit ThreadPool(size_t num_threads, size_t max_pending = 100, QueueMode mode = QueueMode::kMutex,
+                        std::vector<CpuSet> affinity = {}) :
+        max_pending_tasks_(mode == QueueMode::kLockFree ? std::min(max_pending, kMaxRingCapacity) : max_pending),
+        started_(static_cast<std::ptrdiff_t>(num_threads)){
+        if (!affinity.empty()) {
+            for (size_t i = 0; i < num_threads; ++i) {
+                worker_cpus_.push_back(affinity[i % affinity.size()]);
+            }
+        }
+        //等待中与执行中的任务数不会超过 max_pending + num_threads，节点池按这个数量预先分配
+        node_count_ = std::min(max_pending, kMaxPooledNodes) + num_threads;
+        nodes_ = std::make_unique<Task[]>(node_count_);
+        free_nodes_ = std::make_unique<detail::MpmcQueue<Task*>>(node_count_);
+        for (size_t i = 0; i < node_count_; ++i) {
+            free_nodes_->push(&nodes_[i]);
+        }
+        if (mode == QueueMode::kLockFree) {
+            ring_ = std::make_unique<detail::MpmcQueue<Task*>>(max_pending_tasks_);
+        } else {
+            injected_.resize(std::min(max_pending, kMaxPooledNodes));
+        }
+        //本地队列不会超过等待任务上限，过大的上限只影响全局队列
+        size_t local_capacity = std::min(max_pending, kMaxLocalCapacity);
+        workers_.resize(num_threads);
+        //创建指定数量的工作线程，等所有线程都建好自己的队列后再返回
         for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this] {
-                //工作线程的主循环
-                while (true) {
-                    std::function<void()> task;
-                    {
-                        //等待任务或停止信号
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this] {
-                            return stop_ || !tasks_.empty();  //条件：停止或有任务
-                        });
-
-                        //检查是否需要退出
-                        if (stop_ && tasks_.empty()) return;
-
-                        //获取任务
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-
-                    }
-                    //执行任务（在锁外执行，避免阻塞其他线程）
-                    task();
-                }
+            threads_.emplace_back([this, i, local_capacity] {
+                start_worker(i, local_capacity);
+                started_.arrive_and_wait();
+                worker_loop(i);
             });
         }
+        started_.wait();
     }
 
     /**
      * @brief 提交任务到线程池
-     * @param task 要执行的任务函数
+     * @param task 要执行的任务函数，可以只能移动；提交失败时不会被移走，调用者仍持有它
      * @return true-提交成功，false-队列已满（用于拒绝新连接）
      */
-    auto enqueue(std::function<void()> task) -> bool{
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            //检查队列是否已满
-            if (tasks_.size() >= max_pending_tasks_) {
-                return false;
-            }
+    template <typename F>
+        requires std::is_constructible_v<Task, F>
+    auto enqueue(F&& task) -> bool{
+        if (!reserve()) {
+            return false;
+        }
+
+        Task* item = acquire_node(std::forward<F>(task));
+        if (current_.pool != this || !workers_[current_.index]->deque.push(item)) {
+            inject(item);
+        }
+        wake_one();
+        return true;
+    }
+
+    /**
+     * @brief 提交任务到指定的工作线程，让处理连接的线程与收包的 CPU 保持一致
+     * @param worker 工作线程编号（通常由 worker_for_cpu() 得到），超出范围时取模
+     * @param task 要执行的任务函数，提交失败时不会被移走
+     * @return true-提交成功，false-队列已满
+     */
+    template <typename F>
+        requires std::is_constructible_v<Task, F>
+    auto enqueue_to(size_t worker, F&& task) -> bool{
+        if (workers_.empty()) {
+            return enqueue(std::forward<F>(task));
+        }
+        if (!reserve()) {
+            return false;
+        }
+
+        worker %= workers_.size();
+        Task* item = acquire_node(std::forward<F>(task));
+        if (!workers_[worker]->inbox.push(item)) {
+            //收件箱满时退回全局队列，与 enqueue 一样在入队失败时重试，不会丢掉任务
+            inject(item);
+            wake_one();
+            return true;
+        }
+        wake_worker(worker);
+        return true;
+    }
+
+    /**
+     * @brief 选择与给定 CPU 最近的工作线程
+     * @param cpu CPU 编号，例如 incoming_cpu(fd) 的结果
+     * @return 绑定在该 CPU 上的线程；没有时选同一 NUMA 节点上的线程；未绑定 CPU 或 CPU 未知时按编号取模
+     */
+    [[nodiscard]]
+    auto worker_for_cpu(int cpu) const -> size_t{
+        if (workers_.empty() || cpu < 0) {
+            return 0;
+        }
+        if (worker_cpus_.empty()) {
+            return static_cast<size_t>(cpu) % workers_.size();
+        }
+        for (size_t i = 0; i < worker_cpus_.size(); ++i) {
+            if (worker_cpus_[i].contains(cpu)) return i;
+        }
+        CpuSet node = node_cpus(cpu);
+        std::vector<size_t> nearby;
+        for (size_t i = 0; i < worker_cpus_.size(); ++i) {
+            if (!(worker_cpus_[i] & node).empty()) nearby.push_back(i);
+        }
+        return nearby.empty() ? static_cast<size_t>(cpu) % workers_.size()
+                              : nearby[static_cast<size_t>(cpu) % nearby.size()];
+    }
+
+    //工作线程是否绑定了 CPU
+    [[nodiscard]]
+    auto pinned() const -> bool{ return !worker_cpus_.empty(); }
+
+    /**
+     * @brief 提交任务并返回可以等待结果的 future
+     * @param task 要执行的任务函数，返回值通过 Future::get() 取得
+     * @return 任务的 future；队列已满时任务直接在调用线程执行，返回的 future 已经就绪
+     */
+    template <typename F>
+    auto submit(F&& task) -> Future<std::invoke_result_t<std::decay_t<F>&>>{
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        auto state = std::make_shared<detail::FutureState<R>>();
+        auto job = [state, fn = std::forward<F>(task)]() mutable { state->run(fn); };
+        if (!enqueue(std::move(job))) {
+            job();
+        }
+        return Future<R>{this, std::move(state)};
+    }
 
-            //任务入队
-            tasks_.push(std::move(task));
+    /**
+     * @brief 在当前线程执行一个等待中的任务，用于等待结果时帮忙干活
+     * @return true-执行了一个任务，false-当前线程不是本线程池的工作线程或没有等待的任务
+     */
+    auto run_pending_task() -> bool{
+        if (current_.pool != this) {
+            return false;
+        }
+        Task* task = find_task(current_.index);
+        if (!task) {
+            return false;
         }
-        //通知一个等待的工作线程
-        condition_.notify_one();
+        pending_.fetch_sub(1, std::memory_order_seq_cst);
+        (*task)();
+        release_node(task);
         return true;
     }
 
-    //析构用于优雅地关闭线程池（RAII）
+    //工作线程数量
+    [[nodiscard]]
+    auto size() const -> size_t{ return threads_.size(); }
+
+    //析构用于优雅地关闭线程池（RAII），已提交的任务会全部执行完
     ~ThreadPool(){
+        std::vector<size_t> sleeping;
         {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
+            std::lock_guard<std::mutex> lock(idle_mutex_);
             stop_ = true;  //设置停止标志
+            sleeping.swap(idle_);
+            idle_count_.store(0, std::memory_order_relaxed);
+            searching_.fetch_add(sleeping.size(), std::memory_order_relaxed);
+        }
+        //唤醒所有休眠的工作线程
+        for (size_t index : sleeping) {
+            workers_[index]->wakeup.release();
         }
-        //通知所有工作线程
-        condition_.notify_all();
         //等待所有工作线程结束
-        for (std::thread &worker : workers_) {
+        for (std::thread &worker : threads_) {
             if (worker.joinable()) worker.join();
         }
     }
 
 private:
-    std::vector<std::thread> workers_;          //工作线程集合
-    std::queue<std::function<void()>> tasks_;   //任务队列
-    std::mutex queue_mutex_;                    //保护任务队列的互斥锁
-    std::condition_variable condition_;         //线程间通信的条件变量
-    std::atomic<bool> stop_;                    //停止标志（原子操作）
-    const size_t max_pending_tasks_;            //最大等待任务数
+    static constexpr size_t kMaxLocalCapacity = 4096;
+    static constexpr size_t kMaxPooledNodes = 4096;         //上限更大时超出的部分退回堆分配
+    static constexpr size_t kMaxRingCapacity = 1 << 20;
+    static constexpr size_t kMaxInboxCapacity = 1024;
+    static constexpr uint32_t kSpinRounds = 256;            //休眠前自旋检查新任务的次数
+    static constexpr uint32_t kGlobalPollInterval = 61;    //每执行这么多任务优先检查一次全局队列，避免外部任务饿死
+
+    struct alignas(64) Worker {
+        Worker(size_t capacity, size_t index)
+            : deque(capacity), inbox(std::min(capacity, kMaxInboxCapacity)),
+              rng(static_cast<uint32_t>(index) * 2654435761u + 1){}
+
+        detail::WorkStealingDeque<Task> deque;
+        detail::MpmcQueue<Task*> inbox;     //enqueue_to() 指定给本线程的任务
+        std::binary_semaphore wakeup{0};    //休眠时等待的信号量，每次休眠最多被释放一次
+        uint32_t tick{0};
+        uint32_t rng;                       //选择窃取起点的随机数状态
+    };
+
+    //当前线程所属的线程池及其工作线程编号，用于判断任务能否压入本地队列
+    struct CurrentWorker {
+        ThreadPool* pool;
+        size_t index;
+    };
+    static inline thread_local CurrentWorker current_{nullptr, 0};
+
+    //在工作线程中绑定 CPU 并分配本线程的队列，队列内存落在本地 NUMA 节点
+    auto start_worker(size_t index, size_t local_capacity) -> void{
+        if (!worker_cpus_.empty()) {
+            if (auto pinned = pin_current_thread(worker_cpus_[index]); !pinned) {
+                LOG_WARN("Failed to pin worker {}: {}", index, pinned.error());
+            }
+        }
+        workers_[index] = std::make_unique<Worker>(local_capacity, index);
+    }
+
+    //先占用名额再入队，等待任务数不会超过上限
+    auto reserve() -> bool{
+        if (pending_.fetch_add(1, std::memory_order_seq_cst) >= max_pending_tasks_) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    auto worker_loop(size_t index) -> void{
+        current_ = {this, index};
+        bool searching = false;    //被唤醒后还没有找到任务
+        while (true) {
+            Task* task = find_task(index);
+            if (!task && spin_enabled()) {
+                task = spin_for_task(index, searching);
+            }
+            if (task) {
+                pending_.fetch_sub(1, std::memory_order_seq_cst);
+                //最后一个寻找者找到了任务，接力唤醒下一个线程处理剩余任务
+                if (searching) {
+                    searching = false;
+                    if (searching_.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+                        wake_one();
+                    }
+                }
+                //执行任务（不持有任何锁）
+                (*task)();
+                release_node(task);
+                continue;
+            }
+
+            if (searching) {
+                searching = false;
+                searching_.fetch_sub(1, std::memory_order_seq_cst);
+            }
+            if (!park(index, searching)) return;
+        }
+    }
+
+    //依次查找本地队列、全局队列，最后从随机位置开始窃取其他线程
+    auto find_task(size_t index) -> Task*{
+        Worker& self = *workers_[index];
+        if (++self.tick % kGlobalPollInterval == 0) {
+            if (Task* task = pop_injected()) return task;
+        }
+        if (Task* task = self.deque.pop()) return task;
+        if (Task* task = nullptr; self.inbox.pop(task)) return task;
+        if (Task* task = pop_injected()) return task;
+
+        size_t n = workers_.size();
+        self.rng ^= self.rng << 13;
+        self.rng ^= self.rng >> 17;
+        self.rng ^= self.rng << 5;
+        size_t start = self.rng % n;
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (start + k) % n;
+            if (victim == index) continue;
+            if (Task* task = workers_[victim]->deque.steal()) return task;
+        }
+        //最后才取其他线程收件箱中的任务，尽量让任务留在指定的线程上
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (start + k) % n;
+            if (victim == index) continue;
+            if (Task* task = nullptr; workers_[victim]->inbox.pop(task)) return task;
+        }
+        return nullptr;
+    }
+
+    //从节点池取一个空节点放入任务，节点池用完时在堆上分配
+    template <typename F>
+    auto acquire_node(F&& task) -> Task*{
+        Task* node = nullptr;
+        if (free_nodes_->pop(node)) {
+            *node = Task(std::forward<F>(task));
+            return node;
+        }
+        return new Task(std::forward<F>(task));
+    }
+
+    //销毁任务持有的可调用对象，节点归还节点池
+    auto release_node(Task* node) -> void{
+        node->reset();
+        if (std::less_equal<>{}(nodes_.get(), node) && std::less<>{}(node, nodes_.get() + node_count_)) {
+            free_nodes_->push(node);
+        } else {
+            delete node;
+        }
+    }
+
+    //自旋期间计入寻找者，新提交的任务交给自旋的线程而不再唤醒休眠的线程
+    auto spin_for_task(size_t index, bool& searching) -> Task*{
+        if (!searching) {
+            searching = true;
+            searching_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        for (uint32_t i = 0; i < kSpinRounds; ++i) {
+            if (pending_.load(std::memory_order_relaxed) > 0) {
+                if (Task* task = find_task(index)) return task;
+            }
+            detail::cpu_relax();
+        }
+        return nullptr;
+    }
+
+    //单核机器上自旋只会占用生产者需要的时间片，直接休眠
+    static auto spin_enabled() -> bool{
+        static const bool enabled = std::thread::hardware_concurrency() > 1;
+        return enabled;
+    }
+
+    //放入全局队列；无锁模式下环中对应的槽位还没被消费者释放时返回 false
+    [[nodiscard]]
+    auto push_injected(Task* task) -> bool{
+        if (ring_) {
+            return ring_->push(task);
+        }
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        size_t count = injected_count_.load(std::memory_order_relaxed);
+        if (count == injected_.size()) {
+            //环满时按两倍扩容，之后一直复用，不会每次入队都分配
+            std::vector<Task*> grown(std::max<size_t>(injected_.size() * 2, 16));
+            for (size_t i = 0; i < count; ++i) {
+                grown[i] = injected_[(injected_head_ + i) % injected_.size()];
+            }
+            injected_.swap(grown);
+            injected_head_ = 0;
+        }
+        injected_[(injected_head_ + count) % injected_.size()] = task;
+        injected_count_.store(count + 1, std::memory_order_release);
+        return true;
+    }
+
+    //占用名额后放入全局队列，失败时退避重试
+    //
+    //环的容量不小于等待任务上限，占用名额后环中的任务数不会达到容量；push 失败只说明
+    //某个消费者已经取走槽位中的任务但还没更新槽位序号，它完成这一步后重试就会成功。
+    //不在失败时撤销提交：任务已经移入节点，撤销会让调用者丢掉任务。
+    auto inject(Task* task) -> void{
+        for (uint32_t attempt = 0; !push_injected(task); ++attempt) {
+            if (attempt < kSpinRounds) {
+                detail::cpu_relax();
+            } else {
+                //消费者可能在两步之间被抢占，让出 CPU 等它继续
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    auto pop_injected() -> Task*{
+        if (ring_) {
+            Task* task = nullptr;
+            return ring_->pop(task) ? task : nullptr;
+        }
+        if (injected_count_.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        size_t count = injected_count_.load(std::memory_order_relaxed);
+        if (count == 0) {
+            return nullptr;
+        }
+        Task* task = injected_[injected_head_];
+        injected_head_ = (injected_head_ + 1) % injected_.size();
+        injected_count_.store(count - 1, std::memory_order_relaxed);
+        return task;
+    }
+
+    //登记为空闲后休眠；返回 false 表示线程池已停止且没有剩余任务
+    //searching 置为 true 表示由 wake_one 唤醒，已计入寻找者数量
+    auto park(size_t index, bool& searching) -> bool{
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            if (stop_) {
+                return pending_.load(std::memory_order_seq_cst) > 0;
+            }
+            idle_.push_back(index);
+            idle_count_.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        //登记之后再检查一次，与 enqueue 的“入队后检查空闲数”配对，避免丢失唤醒
+        if (pending_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            if (auto it = std::find(idle_.begin(), idle_.end(), index); it != idle_.end()) {
+                idle_.erase(it);
+                idle_count_.fetch_sub(1, std::memory_order_relaxed);
+                //与被唤醒一样计入寻找者：此时 enqueue 可能因为看到本线程空闲而没有唤醒别人，
+                //找到任务后要负责接力唤醒，否则多个任务只有本线程在处理
+                searching = true;
+                searching_.fetch_add(1, std::memory_order_seq_cst);
+                return true;
+            }
+            //已经被其他线程选中唤醒，继续往下消耗掉这次唤醒
+        }
+
+        workers_[index]->wakeup.acquire();
+        searching = true;
+        return true;
+    }
+
+    //唤醒指定的线程；它没有休眠时按普通任务唤醒一个空闲线程，指定的线程忙时由其他线程窃取
+    auto wake_worker(size_t index) -> void{
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool found = false;
+        if (idle_count_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            if (auto it = std::find(idle_.begin(), idle_.end(), index); it != idle_.end()) {
+                idle_.erase(it);
+                idle_count_.fetch_sub(1, std::memory_order_relaxed);
+                searching_.fetch_add(1, std::memory_order_seq_cst);
+                found = true;
+            }
+        }
+        if (found) {
+            workers_[index]->wakeup.release();
+        } else {
+            wake_one();
+        }
+    }
+
+    //有等待的任务且没有线程正在寻找任务时，唤醒一个空闲线程
+    auto wake_one() -> void{
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idle_count_.load(std::memory_order_seq_cst) == 0 ||
+            searching_.load(std::memory_order_seq_cst) > 0 ||
+            pending_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            if (idle_.empty()) return;
+            index = idle_.back();
+            idle_.pop_back();
+            idle_count_.fetch_sub(1, std::memory_order_relaxed);
+            searching_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        workers_[index]->wakeup.release();
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;  //每个工作线程的本地队列与休眠信号量
+    std::vector<CpuSet> worker_cpus_;               //每个工作线程绑定的 CPU，未绑定时为空
+    const size_t max_pending_tasks_;                //最大等待任务数
+    std::latch started_;                            //所有工作线程都建好队列后才开始调度
+    std::vector<std::thread> threads_;              //工作线程集合
+    std::atomic<size_t> pending_{0};                //已提交但还没开始执行的任务数
+
+    std::unique_ptr<Task[]> nodes_;                 //预先分配的任务节点
+    size_t node_count_{0};
+    std::unique_ptr<detail::MpmcQueue<Task*>> free_nodes_;  //空闲的任务节点
+
+    std::unique_ptr<detail::MpmcQueue<Task*>> ring_;    //无锁模式下的全局队列，互斥锁模式下为空
+    std::mutex inject_mutex_;                       //保护全局注入队列
+    std::vector<Task*> injected_;                   //外部线程提交的任务（环形缓冲区）
+    size_t injected_head_{0};
+    std::atomic<size_t> injected_count_{0};         //全局队列长度，空队列时免加锁
+
+    std::mutex idle_mutex_;                         //保护空闲线程列表与停止标志
+    std::vector<size_t> idle_;                      //休眠中的工作线程编号
+    std::atomic<size_t> idle_count_{0};
+    std::atomic<size_t> searching_{0};              //已被唤醒但还没找到任务的线程数
+    bool stop_{false};                              //停止标志
 };
 
+template <typename T>
+auto Future<T>::wait() const -> void{
+    while (!ready()) {
+        //工作线程阻塞会占掉线程池的一个线程，甚至与等待的任务互相等待，先执行其他任务
+        if (pool_ && pool_->run_pending_task()) {
+            continue;
+        }
+        state_->ready.wait(false, std::memory_order_acquire);
+    }
+}
+
 }// namespace saxio
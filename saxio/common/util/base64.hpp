@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <cstdint>
+
+namespace saxio::util
+{
+//Base64 编码（标准字母表，带填充）
+inline auto base64_encode(std::string_view data) -> std::string{
+    static constexpr char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t n = static_cast<uint8_t>(data[i]) << 16
+                   | static_cast<uint8_t>(data[i + 1]) << 8
+                   | static_cast<uint8_t>(data[i + 2]);
+        out += kAlphabet[n >> 18 & 0x3f];
+        out += kAlphabet[n >> 12 & 0x3f];
+        out += kAlphabet[n >> 6 & 0x3f];
+        out += kAlphabet[n & 0x3f];
+    }
+    if (i < data.size()) {
+        uint32_t n = static_cast<uint8_t>(data[i]) << 16;
+        if (i + 1 < data.size()) n |= static_cast<uint8_t>(data[i + 1]) << 8;
+        out += kAlphabet[n >> 18 & 0x3f];
+        out += kAlphabet[n >> 12 & 0x3f];
+        out += i + 1 < data.size() ? kAlphabet[n >> 6 & 0x3f] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+//Base64 解码，同时接受标准字母表和 URL 安全字母表（"-" "_"），填充可省略
+//遇到非法字符时返回 std::nullopt
+inline auto base64_decode(std::string_view data) -> std::optional<std::string>{
+    auto value_of = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+' || c == '-') return 62;
+        if (c == '/' || c == '_') return 63;
+        return -1;
+    };
+
+    while (!data.empty() && data.back() == '=') data.remove_suffix(1);
+    if (data.size() % 4 == 1) return std::nullopt;
+
+    std::string out;
+    out.reserve(data.size() * 3 / 4);
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : data) {
+        int v = value_of(c);
+        if (v < 0) return std::nullopt;
+        buffer = buffer << 6 | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>(buffer >> bits & 0xff);
+        }
+    }
+    return out;
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <cstdint>
+
+namespace saxio::util
+{
+//SHA-1 摘要（RFC 3174），仅用于协议要求的场景（如 WebSocket 握手），不要用于安全校验
+inline auto sha1(std::string_view data) -> std::array<uint8_t, 20>{
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    auto rotl = [](uint32_t x, int n) { return x << n | x >> (32 - n); };
+
+    auto process = [&](const uint8_t* block) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = static_cast<uint32_t>(block[i * 4]) << 24 | static_cast<uint32_t>(block[i * 4 + 1]) << 16
+                 | static_cast<uint32_t>(block[i * 4 + 2]) << 8 | static_cast<uint32_t>(block[i * 4 + 3]);
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5a827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ed9eba1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdc; }
+            else { f = b ^ c ^ d; k = 0xca62c1d6; }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    };
+
+    size_t pos = 0;
+    for (; pos + 64 <= data.size(); pos += 64) {
+        process(reinterpret_cast<const uint8_t*>(data.data() + pos));
+    }
+
+    //填充：0x80，补零到 56 字节（模64），最后8字节为消息比特长度（大端）
+    uint8_t tail[128] = {};
+    size_t rest = data.size() - pos;
+    for (size_t i = 0; i < rest; ++i) tail[i] = static_cast<uint8_t>(data[pos + i]);
+    tail[rest] = 0x80;
+    size_t tail_size = rest < 56 ? 64 : 128;
+    uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    for (int i = 0; i < 8; ++i) tail[tail_size - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+    process(tail);
+    if (tail_size == 128) process(tail + 64);
+
+    std::array<uint8_t, 20> digest{};
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+    return digest;
+}
+}
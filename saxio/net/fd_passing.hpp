@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+
+namespace saxio::net{
+
+namespace detail {
+
+//通过 UNIX 套接字发送文件描述符（SCM_RIGHTS）
+inline auto send_fds(int sock, const std::vector<int>& fds) -> bool{
+    char tag = 'F';
+    iovec iov{&tag, 1};
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+    ssize_t ret;
+    do {
+        ret = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (ret < 0 && errno == EINTR);
+    return ret == 1;
+}
+
+//从 UNIX 套接字接收最多 max_fds 个文件描述符，收到的描述符带 FD_CLOEXEC
+inline auto recv_fds(int sock, size_t max_fds) -> std::vector<int>{
+    char tag = 0;
+    iovec iov{&tag, 1};
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * max_fds));
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t ret;
+    do {
+        ret = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while (ret < 0 && errno == EINTR);
+
+    std::vector<int> fds;
+    if (ret != 1) return fds;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        fds.resize(n);
+        std::memcpy(fds.data(), CMSG_DATA(cmsg), sizeof(int) * n);
+    }
+    return fds;
+}
+
+} // namespace detail
+
+}// namespace saxio
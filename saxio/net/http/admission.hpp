@@ -0,0 +1,163 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <format>
+
+namespace saxio::http{
+
+//准入控制：限制并发连接数和同时处理的请求数，并按排队延迟（CoDel）主动丢弃请求
+//
+//请求的排队时间从连接被 accept 算起，到拿到处理名额为止。排队时间持续一个 interval
+//都高于 target 时进入丢弃状态，新请求直接返回预先生成的 503，直到排队时间回落到 target 以下。
+//这样过载时只有一部分请求被快速拒绝，而不是所有请求的延迟一起变差。
+class AdmissionControl {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AdmissionControl(){
+        rebuild_busy_response();
+    }
+
+    //最大并发连接数，超出时在 accept 线程中直接回复 503 并关闭（0 表示不限制）
+    auto set_max_connections(size_t n) -> void{ max_connections_ = n; }
+
+    //最大同时处理的请求数，超出的请求排队等待名额（0 表示不限制）
+    auto set_max_inflight_requests(size_t n) -> void{
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_inflight_ = n;
+        slot_available_.notify_all();
+    }
+
+    //CoDel 参数：目标排队延迟和观察窗口（target 为 0 时关闭按延迟丢弃）
+    auto set_queue_delay(std::chrono::milliseconds target, std::chrono::milliseconds interval) -> void{
+        std::lock_guard<std::mutex> lock(mutex_);
+        target_ = target;
+        interval_ = interval;
+    }
+
+    //等待处理名额的最长时间，超时的请求直接拒绝
+    auto set_max_queue_time(std::chrono::milliseconds timeout) -> void{
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_queue_time_ = timeout;
+    }
+
+    //503 响应中 Retry-After 的秒数，在服务器启动前设置
+    auto set_retry_after(std::chrono::seconds seconds) -> void{
+        retry_after_ = seconds;
+        rebuild_busy_response();
+    }
+
+    //预先生成的 503 响应，拒绝时直接写出，不再格式化
+    [[nodiscard]]
+    auto busy_response() const -> std::string_view{ return busy_response_; }
+
+    //新连接到达时调用，返回 false 表示超出连接数上限
+    auto try_accept_connection() -> bool{
+        size_t current = connections_.fetch_add(1, std::memory_order_relaxed);
+        if (max_connections_ != 0 && current >= max_connections_) {
+            connections_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    //连接结束时调用
+    auto release_connection() -> void{
+        connections_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    //为请求申请处理名额，arrived_at 为请求开始排队的时间
+    //返回 false 表示请求应被拒绝（排队超时或处于 CoDel 丢弃状态），此时没有占用名额
+    auto admit_request(Clock::time_point arrived_at) -> bool{
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (max_inflight_ != 0) {
+            bool got_slot = slot_available_.wait_until(lock, arrived_at + max_queue_time_, [this] {
+                return max_inflight_ == 0 || inflight_ < max_inflight_;
+            });
+            if (!got_slot) {
+                ++shed_count_;
+                return false;
+            }
+        }
+
+        auto now = Clock::now();
+        if (should_drop(now - arrived_at, now)) {
+            ++shed_count_;
+            return false;
+        }
+        ++inflight_;
+        return true;
+    }
+
+    //请求处理完成后归还名额
+    auto release_request() -> void{
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --inflight_;
+        }
+        slot_available_.notify_one();
+    }
+
+    //当前连接数
+    [[nodiscard]]
+    auto connection_count() const -> size_t{ return connections_.load(std::memory_order_relaxed); }
+
+    //累计被拒绝的请求数
+    [[nodiscard]]
+    auto shed_count() const -> size_t{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shed_count_;
+    }
+
+private:
+    //CoDel（RFC 8289）的简化版：排队时间连续 interval 高于 target 后进入丢弃状态，
+    //排队时间低于 target 时立即退出；调用方需持有 mutex_
+    auto should_drop(Clock::duration sojourn, Clock::time_point now) -> bool{
+        if (target_.count() == 0 || sojourn < target_) {
+            first_above_time_ = {};
+            dropping_ = false;
+            return false;
+        }
+        if (dropping_) {
+            return true;
+        }
+        if (first_above_time_ == Clock::time_point{}) {
+            first_above_time_ = now + interval_;
+            return false;
+        }
+        if (now >= first_above_time_) {
+            dropping_ = true;
+            return true;
+        }
+        return false;
+    }
+
+    auto rebuild_busy_response() -> void{
+        static constexpr std::string_view body = "Server busy, please retry later\n";
+        busy_response_ = std::format(
+            "HTTP/1.1 503 {}\r\nContent-Type: text/plain; charset=utf-8\r\nContent-Length: {}\r\n"
+            "Retry-After: {}\r\nConnection: close\r\n\r\n{}",
+            get_status_text(HttpStatus::SERVICE_UNAVAILABLE), body.size(), retry_after_.count(), body);
+    }
+
+    std::atomic<size_t> connections_{0};     //当前连接数
+    size_t max_connections_{0};              //最大连接数
+    size_t max_inflight_{0};                 //最大同时处理的请求数
+    size_t inflight_{0};                     //正在处理的请求数
+    size_t shed_count_{0};                   //累计拒绝的请求数
+    std::chrono::milliseconds target_{0};                   //CoDel 目标排队延迟
+    std::chrono::milliseconds interval_{100};               //CoDel 观察窗口
+    std::chrono::milliseconds max_queue_time_{1000};        //等待名额的最长时间
+    Clock::time_point first_above_time_{};   //排队时间持续超过 target 的截止时刻
+    bool dropping_{false};                   //是否处于丢弃状态
+    std::chrono::seconds retry_after_{1};    //Retry-After 秒数
+    std::string busy_response_;              //预先生成的 503 响应
+    mutable std::mutex mutex_;
+    std::condition_variable slot_available_;
+};
+
+}
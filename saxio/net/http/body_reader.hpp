@@ -0,0 +1,347 @@
+#pragma once
+
+#include "saxio/net.hpp"
+#include "saxio/common/error.hpp"
+#include "saxio/common/debug.hpp"
+#include <fcntl.h>
+#include <charconv>
+#include <cerrno>
+#include <limits>
+#include <span>
+#include <string>
+#include <algorithm>
+#include <vector>
+
+namespace saxio::http{
+
+//把缓冲区完整写入文件描述符（处理部分写和 EINTR）
+inline auto write_all(int fd, std::string_view data) -> Result<void>{
+    while (!data.empty()) {
+        auto ret = ::write(fd, data.data(), data.size());
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return std::unexpected{make_error(Error::kWriteFailed)};
+        }
+        data.remove_prefix(ret);
+    }
+    return {};
+}
+
+//流式请求体读取器：支持 Content-Length 与 chunked 两种格式，
+//内存占用只与缓冲区大小有关，与请求体大小无关
+class BodyReader {
+public:
+    //请求体的分帧方式
+    enum class Framing {
+        NONE,            //没有请求体
+        CONTENT_LENGTH,  //由 Content-Length 指定长度
+        CHUNKED,         //Transfer-Encoding: chunked
+        UNTIL_CLOSE,     //读到连接关闭为止（仅用于没有长度信息的响应体）
+    };
+
+    /**
+     * @param stream 客户端连接
+     * @param buffered 读取请求头时多读到的数据（请求体的开头部分）
+     * @param framing 请求体分帧方式
+     * @param content_length Content-Length 的值（仅 CONTENT_LENGTH 时有效）
+     * @param max_body_size 请求体最大字节数
+     */
+    BodyReader(net::TcpStream& stream, std::string buffered, Framing framing,
+               size_t content_length = 0,
+               size_t max_body_size = std::numeric_limits<size_t>::max())
+        : stream_(stream), buffer_(std::move(buffered)), framing_(framing),
+          remaining_(content_length), max_body_size_(max_body_size){
+        if (framing_ == Framing::NONE
+            || (framing_ == Framing::CONTENT_LENGTH && content_length == 0)) {
+            done_ = true;
+        }
+    }
+
+    //客户端发送了 Expect: 100-continue，首次读取请求体前先回复 100 Continue
+    //（处理器不读取请求体时就不会诱使客户端发送它）
+    auto set_expect_continue(bool expect) -> void{ expect_continue_ = expect; }
+
+    [[nodiscard]]
+    auto framing() const noexcept -> Framing{ return framing_; }
+
+    //请求体是否已经读完
+    [[nodiscard]]
+    auto done() const noexcept -> bool{ return done_; }
+
+    //已读取的请求体字节数
+    [[nodiscard]]
+    auto bytes_read() const noexcept -> size_t{ return total_; }
+
+    //读取请求体数据，返回0表示请求体已读完
+    [[nodiscard]]
+    auto read(std::span<char> buf) -> Result<size_t>{
+        if (done_ || buf.empty()) return 0;
+        if (auto ret = send_continue(); !ret) {
+            return std::unexpected{ret.error()};
+        }
+
+        if (framing_ == Framing::CONTENT_LENGTH) {
+            if (remaining_ > max_body_size_) {
+                return std::unexpected{make_error(Error::kHttpBodyTooLarge)};
+            }
+            auto n = read_raw(buf.first(std::min(buf.size(), remaining_)));
+            if (!n) return n;
+            //连接在请求体结束前关闭
+            if (n.value() == 0) return std::unexpected{make_error(Error::kReadFailed)};
+            consume(n.value());
+            remaining_ -= n.value();
+            if (remaining_ == 0) done_ = true;
+            return n;
+        }
+
+        if (framing_ == Framing::UNTIL_CLOSE) {
+            auto n = read_raw(buf);
+            if (!n) return n;
+            if (n.value() == 0) {
+                done_ = true;
+                return 0;
+            }
+            if (n.value() > max_body_size_ - std::min(total_, max_body_size_)) {
+                return std::unexpected{make_error(Error::kHttpBodyTooLarge)};
+            }
+            consume(n.value());
+            return n;
+        }
+
+        //chunked：先解析块大小行，再读取块数据
+        while (remaining_ == 0) {
+            if (auto ret = next_chunk(); !ret) {
+                return std::unexpected{ret.error()};
+            }
+            if (done_) return 0;
+        }
+        auto n = read_raw(buf.first(std::min(buf.size(), remaining_)));
+        if (!n) return n;
+        if (n.value() == 0) return std::unexpected{make_error(Error::kReadFailed)};
+        consume(n.value());
+        remaining_ -= n.value();
+        return n;
+    }
+
+    //把整个请求体读入字符串（仅适合较小的请求体）
+    [[nodiscard]]
+    auto read_all(std::string& out) -> Result<size_t>{
+        char buf[16 * 1024];
+        size_t total = 0;
+        while (true) {
+            auto n = read({buf, sizeof(buf)});
+            if (!n) return n;
+            if (n.value() == 0) return total;
+            out.append(buf, n.value());
+            total += n.value();
+        }
+    }
+
+    //把请求体直接写入文件描述符（如上传的临时文件），内存占用恒定
+    //Content-Length 请求体在缓冲数据消耗完后使用 splice() 在内核中搬运数据
+    [[nodiscard]]
+    auto spill_to_fd(int fd) -> Result<size_t>{
+        size_t total = 0;
+        thread_local std::vector<char> buf(64 * 1024);
+        while (!done_) {
+            if (framing_ == Framing::CONTENT_LENGTH && pos_ >= buffer_.size()
+                && !continue_pending() && remaining_ <= max_body_size_ && splice_supported_) {
+                auto spliced = splice_to_fd(fd);
+                if (!spliced) return spliced;
+                total += spliced.value();
+                if (done_) break;   //splice 不可用时回退到普通读写
+            }
+            auto n = read({buf.data(), buf.size()});
+            if (!n) return n;
+            if (n.value() == 0) break;
+            if (auto ret = write_all(fd, {buf.data(), n.value()}); !ret) {
+                return std::unexpected{ret.error()};
+            }
+            total += n.value();
+        }
+        return total;
+    }
+
+    //丢弃剩余的请求体
+    [[nodiscard]]
+    auto discard() -> Result<size_t>{
+        char buf[16 * 1024];
+        size_t total = 0;
+        while (true) {
+            auto n = read({buf, sizeof(buf)});
+            if (!n) return n;
+            if (n.value() == 0) return total;
+            total += n.value();
+        }
+    }
+
+    //取出已读取但尚未消耗的数据，用于连接升级（如 WebSocket）后交给新的协议处理
+    [[nodiscard]]
+    auto take_buffered() -> std::string{
+        std::string rest = buffer_.substr(pos_);
+        buffer_.clear();
+        pos_ = 0;
+        return rest;
+    }
+
+private:
+    [[nodiscard]]
+    auto continue_pending() const noexcept -> bool{
+        return expect_continue_ && !continue_sent_;
+    }
+
+    auto send_continue() -> Result<void>{
+        if (!continue_pending()) return {};
+        continue_sent_ = true;
+        if (auto ret = stream_.write("HTTP/1.1 100 Continue\r\n\r\n"); !ret) {
+            return std::unexpected{ret.error()};
+        }
+        return {};
+    }
+
+    //累计已读取的请求体大小
+    auto consume(size_t n) -> void{ total_ += n; }
+
+    //先消耗缓冲区中的数据，缓冲区为空时直接从连接读取到调用方的缓冲区（避免额外拷贝）
+    auto read_raw(std::span<char> buf) -> Result<size_t>{
+        if (pos_ < buffer_.size()) {
+            size_t n = std::min(buf.size(), buffer_.size() - pos_);
+            std::copy_n(buffer_.data() + pos_, n, buf.data());
+            pos_ += n;
+            if (pos_ == buffer_.size()) {
+                buffer_.clear();
+                pos_ = 0;
+            }
+            return n;
+        }
+        return stream_.read(buf);
+    }
+
+    //读取一行（不含CRLF），用于解析块大小行和尾部字段
+    auto read_line() -> Result<std::string>{
+        while (true) {
+            if (auto end = buffer_.find("\r\n", pos_); end != std::string::npos) {
+                std::string line = buffer_.substr(pos_, end - pos_);
+                pos_ = end + 2;
+                return line;
+            }
+            if (buffer_.size() - pos_ > kMaxLineSize) {
+                return std::unexpected{make_error(Error::kHttpMalformedChunk)};
+            }
+            //整理缓冲区后继续读取
+            buffer_.erase(0, pos_);
+            pos_ = 0;
+            char buf[4096];
+            auto n = stream_.read({buf, sizeof(buf)});
+            if (!n) return std::unexpected{n.error()};
+            if (n.value() == 0) return std::unexpected{make_error(Error::kReadFailed)};
+            buffer_.append(buf, n.value());
+        }
+    }
+
+    //解析下一个块：块数据后的CRLF、块大小行，以及最后一个块后的尾部字段
+    auto next_chunk() -> Result<void>{
+        if (chunk_started_) {
+            auto crlf = read_line();
+            if (!crlf) return std::unexpected{crlf.error()};
+            if (!crlf->empty()) return std::unexpected{make_error(Error::kHttpMalformedChunk)};
+        }
+        chunk_started_ = true;
+
+        auto line = read_line();
+        if (!line) return std::unexpected{line.error()};
+        //忽略块扩展（";" 之后的部分）
+        std::string_view size_str{*line};
+        size_str = size_str.substr(0, size_str.find(';'));
+        while (!size_str.empty() && size_str.back() == ' ') size_str.remove_suffix(1);
+
+        size_t size = 0;
+        auto [ptr, ec] = std::from_chars(size_str.data(), size_str.data() + size_str.size(), size, 16);
+        if (ec != std::errc{} || ptr != size_str.data() + size_str.size() || size_str.empty()) {
+            return std::unexpected{make_error(Error::kHttpMalformedChunk)};
+        }
+
+        if (size == 0) {
+            //最后一个块：跳过尾部字段直到空行
+            while (true) {
+                auto trailer = read_line();
+                if (!trailer) return std::unexpected{trailer.error()};
+                if (trailer->empty()) break;
+            }
+            done_ = true;
+            return {};
+        }
+        if (size > max_body_size_ - std::min(total_, max_body_size_)) {
+            return std::unexpected{make_error(Error::kHttpBodyTooLarge)};
+        }
+        remaining_ = size;
+        return {};
+    }
+
+    //通过管道把连接中的数据 splice 到目标文件描述符，数据不经过用户态
+    //目标不支持 splice 时返回已搬运的字节数，由调用方回退到普通读写
+    auto splice_to_fd(int fd) -> Result<size_t>{
+        int pipe_fds[2];
+        if (::pipe2(pipe_fds, O_CLOEXEC) < 0) {
+            splice_supported_ = false;
+            return 0;
+        }
+        io::detail::FD pipe_read{pipe_fds[0]};
+        io::detail::FD pipe_write{pipe_fds[1]};
+
+        size_t total = 0;
+        while (remaining_ > 0) {
+            auto in = ::splice(stream_.fd(), nullptr, pipe_write.fd(), nullptr,
+                               std::min<size_t>(remaining_, 64 * 1024), SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (in < 0) {
+                if (errno == EINTR) continue;
+                if (total == 0 && errno == EINVAL) {
+                    splice_supported_ = false;
+                    return 0;
+                }
+                return std::unexpected{make_error(Error::kReadFailed)};
+            }
+            if (in == 0) return std::unexpected{make_error(Error::kReadFailed)};
+
+            //把管道中的数据全部搬到目标，目标不支持 splice 时改用 read/write
+            auto pending = static_cast<size_t>(in);
+            while (pending > 0) {
+                auto out = ::splice(pipe_read.fd(), nullptr, fd, nullptr, pending, SPLICE_F_MOVE);
+                if (out > 0) {
+                    pending -= out;
+                    continue;
+                }
+                if (out < 0 && errno == EINTR) continue;
+                char buf[4096];
+                auto n = ::read(pipe_read.fd(), buf, std::min(pending, sizeof(buf)));
+                if (n <= 0) return std::unexpected{make_error(Error::kReadFailed)};
+                if (auto ret = write_all(fd, {buf, static_cast<size_t>(n)}); !ret) {
+                    return std::unexpected{ret.error()};
+                }
+                pending -= n;
+            }
+            remaining_ -= in;
+            total += in;
+            consume(in);
+        }
+        done_ = true;
+        return total;
+    }
+
+    static constexpr size_t kMaxLineSize = 4096;   //块大小行/尾部字段的最大长度
+
+    net::TcpStream& stream_;
+    std::string buffer_;          //已从连接读取但尚未消耗的数据
+    size_t pos_{0};               //buffer_ 中的读取位置
+    Framing framing_;
+    size_t remaining_;            //当前 Content-Length 或当前块剩余的字节数
+    size_t max_body_size_;
+    size_t total_{0};             //已读取的请求体字节数
+    bool done_{false};
+    bool chunk_started_{false};   //是否已经读过至少一个块大小行
+    bool expect_continue_{false};
+    bool continue_sent_{false};
+    bool splice_supported_{true};  //连接是否支持 splice（如内存流不支持）
+};
+
+}
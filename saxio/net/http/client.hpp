@@ -0,0 +1,577 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include "saxio/net/http/parser.hpp"
+#include "saxio/net/http/body_reader.hpp"
+#include "saxio/net.hpp"
+#include "saxio/common/debug.hpp"
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace saxio::http{
+
+//HTTP URL（只支持 http://，不支持 TLS）
+struct Url {
+    std::string host;
+    uint16_t port{80};
+    std::string target{"/"};   //路径和查询串
+
+    //Host 头的值，默认端口时省略端口
+    [[nodiscard]]
+    auto authority() const -> std::string{
+        std::string host_part = host.find(':') != std::string::npos ? "[" + host + "]" : host;
+        return port == 80 ? host_part : std::format("{}:{}", host_part, port);
+    }
+};
+
+//解析 "http://host[:port][/path][?query]"，格式错误时返回 std::nullopt
+inline auto parse_url(std::string_view url) -> std::optional<Url>{
+    constexpr std::string_view kScheme = "http://";
+    if (!url.starts_with(kScheme)) return std::nullopt;
+    url.remove_prefix(kScheme.size());
+
+    size_t authority_end = url.find_first_of("/?");
+    std::string_view authority = url.substr(0, authority_end);
+    Url result;
+    if (authority_end != std::string_view::npos) {
+        result.target = url.substr(authority_end);
+        if (result.target.front() == '?') result.target.insert(0, "/");
+    }
+
+    //IPv6 地址写在方括号中
+    std::string_view port_str;
+    if (authority.starts_with('[')) {
+        size_t close = authority.find(']');
+        if (close == std::string_view::npos) return std::nullopt;
+        result.host = authority.substr(1, close - 1);
+        if (close + 1 < authority.size()) {
+            if (authority[close + 1] != ':') return std::nullopt;
+            port_str = authority.substr(close + 2);
+        }
+    } else {
+        size_t colon = authority.find(':');
+        result.host = authority.substr(0, colon);
+        if (colon != std::string_view::npos) port_str = authority.substr(colon + 1);
+    }
+    if (result.host.empty()) return std::nullopt;
+    if (!port_str.empty()) {
+        auto [ptr, ec] = std::from_chars(port_str.data(), port_str.data() + port_str.size(), result.port);
+        if (ec != std::errc{} || ptr != port_str.data() + port_str.size() || result.port == 0) return std::nullopt;
+    }
+    return result;
+}
+
+//流式请求体的数据来源：填充缓冲区并返回字节数，返回0表示请求体结束
+using BodySource = std::function<Result<size_t>(std::span<char>)>;
+
+//客户端请求
+struct ClientRequest {
+    std::string method{"GET"};
+    std::string url;
+    HeaderList headers;       //额外请求头（未指定时自动添加 Host、Content-Length）
+    std::string body;
+    //流式请求体（设置后忽略 body）：headers 中有 Content-Length 时原样发送，否则使用 chunked 编码
+    BodySource body_source;
+};
+
+//完整读取的响应
+struct ClientResponse : HttpResponse {
+    std::string body;
+};
+
+namespace detail {
+
+//连接池中的连接
+struct PooledConnection {
+    explicit PooledConnection(net::TcpStream s) : stream(std::move(s)){}
+
+    net::TcpStream stream;
+    std::string buffered;     //读取响应头时多读到的数据
+    std::chrono::steady_clock::time_point idle_since;
+    bool reused{false};       //是否是从连接池取出的连接（可能已被服务器关闭）
+};
+
+//发送全部数据（MSG_NOSIGNAL：对端关闭时返回错误而不是产生 SIGPIPE）
+inline auto send_all(int fd, std::string_view data) -> Result<void>{
+    while (!data.empty()) {
+        auto ret = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            bool timeout = errno == EAGAIN || errno == EWOULDBLOCK;
+            return std::unexpected{make_error(timeout ? Error::kTimeout : Error::kWriteFailed)};
+        }
+        data.remove_prefix(ret);
+    }
+    return {};
+}
+
+//读取失败时区分超时（SO_RCVTIMEO 到期时 read 返回 EAGAIN）和其它错误
+inline auto io_error(const Error& error) -> Error{
+    if (error.value() == Error::kReadFailed && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return make_error(Error::kTimeout);
+    }
+    return error;
+}
+
+//响应体的分帧方式（RFC 7230 3.3.3）
+inline auto response_framing(const HttpResponse& response, bool head_request,
+                             size_t& content_length) -> Result<BodyReader::Framing>{
+    content_length = 0;
+    if (head_request || (response.status >= 100 && response.status < 200)
+        || response.status == 204 || response.status == 304) {
+        return BodyReader::Framing::NONE;
+    }
+    if (header_has_token(response.header("transfer-encoding"), "chunked")) {
+        return BodyReader::Framing::CHUNKED;
+    }
+    if (auto length_str = response.header("content-length"); !length_str.empty()) {
+        auto length = parse_content_length(length_str);
+        if (!length) return std::unexpected{make_error(Error::kHttpBadResponse)};
+        content_length = length.value();
+        return BodyReader::Framing::CONTENT_LENGTH;
+    }
+    return BodyReader::Framing::UNTIL_CLOSE;
+}
+
+//响应结束后连接能否复用
+inline auto is_keep_alive(const HttpResponse& response, BodyReader::Framing framing) -> bool{
+    auto connection = response.header("connection");
+    if (framing == BodyReader::Framing::UNTIL_CLOSE || header_has_token(connection, "close")) {
+        return false;
+    }
+    return response.version == "HTTP/1.1" || header_has_token(connection, "keep-alive");
+}
+
+//可以安全重发的方法（RFC 7231 4.2.2）
+inline auto is_idempotent(std::string_view method) -> bool{
+    return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE"
+        || method == "OPTIONS" || method == "TRACE";
+}
+
+}
+
+class Client;
+
+//流式响应：响应头已经读取，响应体按需读取，读完后连接自动归还连接池
+//响应体没有读完就销毁时连接被关闭（剩余数据无法跳过）
+class ResponseStream {
+public:
+    ResponseStream(ResponseStream&&) noexcept = default;
+
+    //响应头
+    [[nodiscard]]
+    auto head() const noexcept -> const HttpResponse&{ return head_; }
+
+    //读取响应体数据，返回0表示响应体已读完
+    [[nodiscard]]
+    auto read(std::span<char> buf) -> Result<size_t>{
+        if (!body_) return 0;
+        auto n = body_->read(buf);
+        if (!n) return std::unexpected{detail::io_error(n.error())};
+        if (n.value() == 0 || body_->done()) finish();
+        return n;
+    }
+
+    //读取剩余的全部响应体
+    [[nodiscard]]
+    auto read_all(std::string& out) -> Result<size_t>{
+        char buf[16 * 1024];
+        size_t total = 0;
+        while (true) {
+            auto n = read({buf, sizeof(buf)});
+            if (!n) return n;
+            if (n.value() == 0) return total;
+            out.append(buf, n.value());
+            total += n.value();
+        }
+    }
+
+private:
+    friend class Client;
+
+    ResponseStream(Client* client, std::string key, std::unique_ptr<detail::PooledConnection> conn,
+                   HttpResponse head, BodyReader::Framing framing, size_t content_length,
+                   size_t max_body_size)
+        : client_(client), key_(std::move(key)), conn_(std::move(conn)), head_(std::move(head)),
+          keep_alive_(detail::is_keep_alive(head_, framing)){
+        body_.emplace(conn_->stream, std::move(conn_->buffered), framing, content_length, max_body_size);
+        if (body_->done()) finish();
+    }
+
+    //响应体读完：可复用的连接归还连接池
+    auto finish() -> void;
+
+    Client* client_;
+    std::string key_;
+    std::unique_ptr<detail::PooledConnection> conn_;
+    HttpResponse head_;
+    std::optional<BodyReader> body_;
+    bool keep_alive_;
+};
+
+//HTTP/1.1 客户端：按主机维护 keep-alive 连接池，支持流水线请求、流式响应体和超时
+//可以在多个线程中共享同一个 Client
+class Client {
+public:
+    Client() = default;
+
+    //设置连接超时
+    auto set_connect_timeout(std::chrono::milliseconds timeout) -> void{ connect_timeout_ = timeout; }
+
+    //设置读写超时（单次读写操作等待的最长时间）
+    auto set_io_timeout(std::chrono::milliseconds timeout) -> void{ io_timeout_ = timeout; }
+
+    //设置每个主机保留的最大空闲连接数（0 表示不复用连接）
+    auto set_max_idle_per_host(size_t count) -> void{ max_idle_per_host_ = count; }
+
+    //设置空闲连接的最长保留时间
+    auto set_idle_timeout(std::chrono::milliseconds timeout) -> void{ idle_timeout_ = timeout; }
+
+    //设置响应体最大字节数（用于 request() 等完整读取响应的接口）
+    auto set_max_response_size(size_t size) -> void{ max_response_size_ = size; }
+
+    //发送 GET 请求并读取完整响应
+    [[nodiscard]]
+    auto get(std::string url) -> Result<ClientResponse>{
+        return request(ClientRequest{"GET", std::move(url), {}, {}, {}});
+    }
+
+    //发送请求并读取完整响应
+    [[nodiscard]]
+    auto request(const ClientRequest& request) -> Result<ClientResponse>{
+        auto stream = open(request);
+        if (!stream) return std::unexpected{stream.error()};
+
+        ClientResponse response;
+        static_cast<HttpResponse&>(response) = stream->head();
+        if (auto ret = stream->read_all(response.body); !ret) {
+            return std::unexpected{ret.error()};
+        }
+        return response;
+    }
+
+    //发送请求并返回流式响应（只读取响应头）
+    //复用的空闲连接已被服务器关闭时，幂等请求会在新连接上自动重发一次
+    [[nodiscard]]
+    auto open(const ClientRequest& request) -> Result<ResponseStream>{
+        auto url = parse_url(request.url);
+        if (!url) return std::unexpected{make_error(Error::kHttpBadUrl)};
+        std::string key = pool_key(*url);
+        std::string data = serialize(request, *url);
+        bool head_request = request.method == "HEAD";
+
+        for (bool fresh = false; ; fresh = true) {
+            auto conn = acquire(*url, key, fresh);
+            if (!conn) return std::unexpected{conn.error()};
+            bool retryable = (*conn)->reused && detail::is_idempotent(request.method);
+
+            if (auto ret = detail::send_all((*conn)->stream.fd(), data); !ret) {
+                if (retryable) continue;
+                return std::unexpected{ret.error()};
+            }
+            //流式请求体只能读取一次，开始发送后就不能再重发
+            if (request.body_source) {
+                retryable = false;
+                if (auto ret = send_body(**conn, request); !ret) return std::unexpected{ret.error()};
+            }
+            bool received = false;
+            auto head = read_response_head(**conn, received);
+            if (!head) {
+                if (retryable && !received) continue;
+                return std::unexpected{head.error()};
+            }
+
+            size_t content_length = 0;
+            auto framing = detail::response_framing(*head, head_request, content_length);
+            if (!framing) return std::unexpected{framing.error()};
+            return ResponseStream{this, std::move(key), std::move(conn.value()), std::move(head.value()),
+                                  framing.value(), content_length, max_response_size_};
+        }
+    }
+
+    //流水线：在同一个连接上连续发送多个请求，再按顺序读取响应，减少往返等待
+    //所有请求必须指向同一主机；服务器中途关闭连接时，剩余的幂等请求在新连接上重发
+    [[nodiscard]]
+    auto pipeline(std::span<const ClientRequest> requests) -> Result<std::vector<ClientResponse>>{
+        std::vector<ClientResponse> responses;
+        if (requests.empty()) return responses;
+
+        auto url = parse_url(requests[0].url);
+        if (!url) return std::unexpected{make_error(Error::kHttpBadUrl)};
+        std::string key = pool_key(*url);
+        std::vector<std::string> serialized;
+        for (const auto& request : requests) {
+            auto request_url = parse_url(request.url);
+            if (!request_url || pool_key(*request_url) != key) {
+                return std::unexpected{make_error(Error::kHttpBadUrl)};
+            }
+            //流式请求体无法在重连后重发，不能用于流水线
+            if (request.body_source) return std::unexpected{make_error(Error::kHttpBadRequest)};
+            serialized.push_back(serialize(request, *request_url));
+        }
+
+        bool fresh = false;
+        while (responses.size() < requests.size()) {
+            size_t first = responses.size();
+            auto conn = acquire(*url, key, fresh);
+            if (!conn) return std::unexpected{conn.error()};
+            bool reused = (*conn)->reused;
+
+            std::string batch;
+            for (size_t i = first; i < requests.size(); ++i) batch += serialized[i];
+            auto sent = detail::send_all((*conn)->stream.fd(), batch);
+
+            //按顺序读取响应，直到全部读完或连接不能继续使用
+            bool keep_alive = true;
+            Error error = make_error(Error::kWriteFailed);
+            while (keep_alive && responses.size() < requests.size()) {
+                const auto& request = requests[responses.size()];
+                bool received = false;
+                auto head = read_response_head(**conn, received);
+                if (!head) {
+                    error = head.error();
+                    keep_alive = false;
+                    break;
+                }
+
+                size_t content_length = 0;
+                auto framing = detail::response_framing(*head, request.method == "HEAD", content_length);
+                if (!framing) return std::unexpected{framing.error()};
+                BodyReader body{(*conn)->stream, std::move((*conn)->buffered), framing.value(),
+                                content_length, max_response_size_};
+                ClientResponse response;
+                static_cast<HttpResponse&>(response) = std::move(head.value());
+                if (auto ret = body.read_all(response.body); !ret) {
+                    return std::unexpected{detail::io_error(ret.error())};
+                }
+                (*conn)->buffered = body.take_buffered();
+                keep_alive = detail::is_keep_alive(response, framing.value());
+                responses.push_back(std::move(response));
+            }
+
+            if (keep_alive && sent) {
+                release(key, std::move(conn.value()));
+                break;
+            }
+
+            //连接提前关闭：新连接上没有任何进展时放弃；剩余请求必须都可以安全重发
+            bool progressed = responses.size() > first;
+            if (!progressed && !reused) return std::unexpected{sent ? error : sent.error()};
+            for (size_t i = responses.size(); i < requests.size(); ++i) {
+                if (!detail::is_idempotent(requests[i].method)) {
+                    return std::unexpected{sent ? error : sent.error()};
+                }
+            }
+            fresh = !progressed;
+        }
+        return responses;
+    }
+
+    //当前连接池中的空闲连接数
+    [[nodiscard]]
+    auto idle_connections() -> size_t{
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        size_t count = 0;
+        for (const auto& [key, conns] : idle_) count += conns.size();
+        return count;
+    }
+
+private:
+    friend class ResponseStream;
+
+    static auto pool_key(const Url& url) -> std::string{
+        return std::format("{}:{}", url.host, url.port);
+    }
+
+    //把请求序列化为 HTTP/1.1 报文
+    static auto serialize(const ClientRequest& request, const Url& url) -> std::string{
+        std::string out = std::format("{} {} HTTP/1.1\r\n", request.method, url.target);
+        bool has_host = false, has_user_agent = false, has_length = false;
+        for (const auto& [name, value] : request.headers) {
+            has_host = has_host || header_has_token(name, "host");
+            has_user_agent = has_user_agent || header_has_token(name, "user-agent");
+            has_length = has_length || header_has_token(name, "content-length");
+            out.append(name).append(": ").append(value).append("\r\n");
+        }
+        if (!has_host) out += std::format("Host: {}\r\n", url.authority());
+        if (!has_user_agent) out += "User-Agent: saxio\r\n";
+        if (request.body_source) {
+            if (!has_length) out += "Transfer-Encoding: chunked\r\n";
+        } else if (!has_length && (!request.body.empty() || request.method == "POST" || request.method == "PUT")) {
+            out += std::format("Content-Length: {}\r\n", request.body.size());
+        }
+        out += "\r\n";
+        if (!request.body_source) out += request.body;
+        return out;
+    }
+
+    //发送流式请求体，没有 Content-Length 时按 chunked 编码
+    static auto send_body(detail::PooledConnection& conn, const ClientRequest& request) -> Result<void>{
+        bool chunked = std::ranges::none_of(request.headers, [](const auto& header) {
+            return header_has_token(header.first, "content-length");
+        });
+        thread_local std::vector<char> buf(64 * 1024);
+        while (true) {
+            auto n = request.body_source({buf.data(), buf.size()});
+            if (!n) return std::unexpected{n.error()};
+            if (n.value() == 0) break;
+            if (chunked) {
+                if (auto ret = detail::send_all(conn.stream.fd(), std::format("{:x}\r\n", n.value())); !ret) return ret;
+            }
+            if (auto ret = detail::send_all(conn.stream.fd(), {buf.data(), n.value()}); !ret) return ret;
+            if (chunked) {
+                if (auto ret = detail::send_all(conn.stream.fd(), "\r\n"); !ret) return ret;
+            }
+        }
+        if (chunked) return detail::send_all(conn.stream.fd(), "0\r\n\r\n");
+        return {};
+    }
+
+    //从连接池取出空闲连接，没有可用连接（或 fresh 为 true）时新建连接
+    auto acquire(const Url& url, const std::string& key, bool fresh)
+        -> Result<std::unique_ptr<detail::PooledConnection>>{
+        if (!fresh) {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            auto& conns = idle_[key];
+            auto now = std::chrono::steady_clock::now();
+            while (!conns.empty()) {
+                auto conn = std::move(conns.back());
+                conns.pop_back();
+                if (now - conn->idle_since > idle_timeout_) continue;
+                //空闲期间对端已关闭（或发来了意外的数据）的连接直接丢弃
+                char probe;
+                auto n = ::recv(conn->stream.fd(), &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+                if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) continue;
+                errno = 0;
+                conn->reused = true;
+                return conn;
+            }
+        }
+
+        auto stream = connect(url);
+        if (!stream) return std::unexpected{stream.error()};
+        return std::make_unique<detail::PooledConnection>(std::move(stream.value()));
+    }
+
+    //归还可复用的连接
+    auto release(const std::string& key, std::unique_ptr<detail::PooledConnection> conn) -> void{
+        if (!conn->buffered.empty()) return;   //响应之后还有多余数据，连接状态不确定
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        auto& conns = idle_[key];
+        if (conns.size() >= max_idle_per_host_) return;
+        conn->idle_since = std::chrono::steady_clock::now();
+        conns.push_back(std::move(conn));
+    }
+
+    //解析主机名并建立连接（非阻塞 connect + poll 实现连接超时），之后设置读写超时
+    auto connect(const Url& url) -> Result<net::TcpStream>{
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        std::string port = std::to_string(url.port);
+        if (::getaddrinfo(url.host.c_str(), port.c_str(), &hints, &result) != 0) {
+            return std::unexpected{make_error(Error::kResolveFailed)};
+        }
+        std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)> guard(result, ::freeaddrinfo);
+
+        Error last_error = make_error(Error::kClientConnectFailed);
+        for (auto* ai = result; ai != nullptr; ai = ai->ai_next) {
+            auto has_socket = net::detail::Socket::create(ai->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (!has_socket) continue;
+            auto socket = std::move(has_socket.value());
+            int fd = socket.fd();
+
+            int flags = fcntl(fd, F_GETFL, 0);
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+                if (errno != EINPROGRESS) continue;
+                pollfd pfd{fd, POLLOUT, 0};
+                int ready = ::poll(&pfd, 1, static_cast<int>(connect_timeout_.count()));
+                if (ready == 0) {
+                    last_error = make_error(Error::kTimeout);
+                    continue;
+                }
+                int so_error = 0;
+                socklen_t len = sizeof(so_error);
+                if (ready < 0 || ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0 || so_error != 0) {
+                    continue;
+                }
+            }
+            fcntl(fd, F_SETFL, flags);
+
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            timeval tv{};
+            tv.tv_sec = static_cast<time_t>(io_timeout_.count() / 1000);
+            tv.tv_usec = static_cast<suseconds_t>(io_timeout_.count() % 1000 * 1000);
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+            LOG_DEBUG("HTTP client connected to {}:{}, fd {}", url.host, url.port, fd);
+            return net::TcpStream{std::move(socket)};
+        }
+        return std::unexpected{last_error};
+    }
+
+    //读取响应头（跳过 1xx 中间响应），多读到的数据留在 conn.buffered 中
+    //received 表示是否收到了任何数据，用于判断能否安全重发
+    auto read_response_head(detail::PooledConnection& conn, bool& received) -> Result<HttpResponse>{
+        char buf[4096];
+        std::string& data = conn.buffered;
+        size_t search_from = 0;
+        received = !data.empty();
+        while (true) {
+            if (auto pos = data.find("\r\n\r\n", search_from); pos != std::string::npos) {
+                HttpResponse response = parse_http_response(std::string_view(data).substr(0, pos + 4));
+                data.erase(0, pos + 4);
+                if (response.status == 0) return std::unexpected{make_error(Error::kHttpBadResponse)};
+                if (response.status >= 100 && response.status < 200 && response.status != 101) {
+                    search_from = 0;
+                    continue;
+                }
+                return response;
+            }
+            if (data.size() > kMaxHeaderSize) return std::unexpected{make_error(Error::kHttpBadResponse)};
+            search_from = data.size() < 3 ? 0 : data.size() - 3;
+
+            auto n = conn.stream.read({buf, sizeof(buf)});
+            if (!n) return std::unexpected{detail::io_error(n.error())};
+            if (n.value() == 0) return std::unexpected{make_error(Error::kReadFailed)};
+            received = true;
+            data.append(buf, n.value());
+        }
+    }
+
+    std::chrono::milliseconds connect_timeout_{std::chrono::seconds(5)};
+    std::chrono::milliseconds io_timeout_{std::chrono::seconds(30)};
+    std::chrono::milliseconds idle_timeout_{std::chrono::seconds(60)};
+    size_t max_idle_per_host_{8};
+    size_t max_response_size_{64 * 1024 * 1024};
+
+    std::mutex pool_mutex_;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<detail::PooledConnection>>> idle_;  //主机 -> 空闲连接
+};
+
+inline auto ResponseStream::finish() -> void{
+    if (conn_ && keep_alive_ && body_ && body_->done()) {
+        conn_->buffered = body_->take_buffered();
+        client_->release(key_, std::move(conn_));
+    }
+    conn_.reset();
+    body_.reset();
+}
+
+}
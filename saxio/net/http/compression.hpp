@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+#ifdef SAXIO_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace saxio::http{
+
+//响应内容编码
+enum class ContentEncoding {
+    IDENTITY,  //不压缩
+    GZIP,      //gzip（RFC 1952）
+    DEFLATE,   //HTTP 中的 deflate，即 zlib 格式（RFC 1950）
+};
+
+//获取 Content-Encoding 头的值
+inline auto get_encoding_name(ContentEncoding encoding) -> std::string_view{
+    switch (encoding) {
+        case ContentEncoding::GZIP: return "gzip";
+        case ContentEncoding::DEFLATE: return "deflate";
+        default: return "identity";
+    }
+}
+
+//判断该MIME类型是否值得压缩（图片等二进制格式本身已经压缩过）
+inline auto is_compressible(std::string_view mime_type) -> bool{
+    return mime_type.starts_with("text/")
+        || mime_type == "application/javascript"
+        || mime_type == "application/json"
+        || mime_type == "image/svg+xml";
+}
+
+//根据 Accept-Encoding 协商编码：选择 q 值最高的可用编码，q=0 表示禁止
+//"*" 只作用于没有单独列出的编码，"gzip;q=0, *" 不会选择 gzip
+//allow_deflate 为 false 时只考虑 gzip（例如只有预压缩的 .gz 文件可用）
+inline auto negotiate_encoding(std::string_view accept_encoding,
+                               bool allow_deflate = true) -> ContentEncoding{
+    std::optional<double> gzip_q;
+    std::optional<double> deflate_q;
+    std::optional<double> any_q;
+
+    size_t start = 0;
+    while (start < accept_encoding.size()) {
+        size_t end = accept_encoding.find(',', start);
+        if (end == std::string_view::npos) end = accept_encoding.size();
+        std::string_view item = accept_encoding.substr(start, end - start);
+        start = end + 1;
+
+        //拆分编码名与参数（如 "gzip;q=0.8"）
+        std::string_view name = item.substr(0, item.find(';'));
+        while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+        while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+
+        double q = 1.0;
+        if (auto pos = item.find("q="); pos != std::string_view::npos) {
+            q = std::strtod(std::string(item.substr(pos + 2)).c_str(), nullptr);
+        }
+
+        //先记录每个编码的 q 值（包括 q=0），解析完再决定 "*" 适用于哪些编码
+        if (name == "gzip" || name == "x-gzip") {
+            gzip_q = q;
+        } else if (name == "deflate") {
+            deflate_q = q;
+        } else if (name == "*") {
+            any_q = q;
+        }
+    }
+
+    double gzip = gzip_q.value_or(any_q.value_or(0.0));
+    double deflate = allow_deflate ? deflate_q.value_or(any_q.value_or(0.0)) : 0.0;
+    //q 值相同时优先 gzip（兼容性更好）
+    if (gzip > 0.0 && gzip >= deflate) return ContentEncoding::GZIP;
+    if (deflate > 0.0) return ContentEncoding::DEFLATE;
+    return ContentEncoding::IDENTITY;
+}
+
+//压缩数据，未编译 zlib 支持或压缩失败时返回 std::nullopt
+inline auto compress(std::string_view data, ContentEncoding encoding) -> std::optional<std::string>{
+#ifdef SAXIO_HAS_ZLIB
+    if (encoding == ContentEncoding::IDENTITY) return std::nullopt;
+
+    z_stream zs{};
+    //windowBits: 15 为 zlib 格式，加 16 表示输出 gzip 头尾
+    int window_bits = encoding == ContentEncoding::GZIP ? 15 + 16 : 15;
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits,
+                     8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::nullopt;
+    }
+
+    std::string out;
+    out.resize(deflateBound(&zs, data.size()));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+
+    int ret = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if (ret != Z_STREAM_END) return std::nullopt;
+
+    out.resize(zs.total_out);
+    return out;
+#else
+    (void)data;
+    (void)encoding;
+    return std::nullopt;
+#endif
+}
+
+//压缩结果缓存：以内容标识（ETag，即内容哈希或文件版本）和编码为键，
+//同一份内容只压缩一次，超出内存上限时淘汰最久未使用的条目
+class CompressionCache {
+public:
+    explicit CompressionCache(size_t max_bytes = 64 * 1024 * 1024)
+        : max_bytes_(max_bytes){}
+
+    //查找压缩结果，未命中时调用 loader 获取原始内容并压缩
+    //返回 nullptr 表示无法压缩（或压缩后反而更大），调用方应发送原始内容
+    template <typename Loader>
+    auto get_or_compress(const std::string& content_key, ContentEncoding encoding,
+                         Loader&& loader) -> std::shared_ptr<const std::string>{
+        std::string key = content_key;
+        key += get_encoding_name(encoding);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto it = entries_.find(key); it != entries_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+                return it->second.data;
+            }
+        }
+
+        //在锁外压缩，并发未命中最多导致重复压缩一次，不会阻塞其它请求
+        std::optional<std::string> original = loader();
+        std::shared_ptr<const std::string> result;
+        if (original) {
+            if (auto compressed = compress(*original, encoding);
+                compressed && compressed->size() < original->size()) {
+                result = std::make_shared<const std::string>(std::move(*compressed));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.contains(key)) {
+            return entries_[key].data;
+        }
+        //不可压缩的结果同样缓存（data 为空），避免重复尝试
+        size_t cost = key.size() + (result ? result->size() : 0);
+        lru_.push_front(key);
+        entries_.emplace(key, Entry{result, cost, lru_.begin()});
+        used_bytes_ += cost;
+        evict();
+        return result;
+    }
+
+private:
+    //淘汰最久未使用的条目，直到内存占用不超过上限
+    auto evict() -> void{
+        while (used_bytes_ > max_bytes_ && lru_.size() > 1) {
+            auto it = entries_.find(lru_.back());
+            used_bytes_ -= it->second.cost;
+            entries_.erase(it);
+            lru_.pop_back();
+        }
+    }
+
+    struct Entry {
+        std::shared_ptr<const std::string> data;   //压缩后的内容（为空表示不压缩）
+        size_t cost{0};                            //占用的字节数
+        std::list<std::string>::iterator lru_pos;  //在 LRU 链表中的位置
+    };
+
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;    //最近使用的键在表头
+    size_t used_bytes_{0};
+    const size_t max_bytes_;
+    std::mutex mutex_;
+};
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string_view>
+
+namespace saxio::http{
+
+//编译期嵌入的静态资源（由 CMake 的 saxio_embed_assets() 生成资源表）
+//所有字段都指向只读数据段中的常量，发送时不访问文件系统
+struct EmbeddedAsset {
+    std::string_view path;        //相对挂载点的 URL 路径，以 '/' 开头
+    std::string_view mime_type;   //MIME 类型
+    std::string_view etag;        //构建时按内容计算的强 ETag
+    std::string_view data;        //文件内容
+};
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include <sys/stat.h>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <format>
+
+namespace saxio::http{
+
+//文件元数据（用于条件请求：ETag / Last-Modified）
+struct FileMeta {
+    size_t size{0};                //文件大小
+    std::time_t mtime{0};          //最后修改时间（秒）
+    std::string etag;              //强ETag，由 inode、大小和修改时间（纳秒）生成
+    std::string last_modified;     //格式化好的 Last-Modified 值
+};
+
+//文件元数据缓存：ETag 与 Last-Modified 只在文件变化时重新生成，
+//同一路径在重新校验间隔内不会再次 stat()
+class FileMetaCache {
+public:
+    explicit FileMetaCache(std::chrono::milliseconds revalidate_interval = std::chrono::seconds(1))
+        : revalidate_interval_(revalidate_interval){}
+
+    //获取文件元数据，文件不存在（或不是普通文件）时返回 nullptr
+    auto lookup(const std::string& path) -> std::shared_ptr<const FileMeta>{
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto it = entries_.find(path); it != entries_.end()
+                && now - it->second.checked_at < revalidate_interval_) {
+                return it->second.meta;
+            }
+        }
+
+        //在锁外执行系统调用
+        struct stat st{};
+        if (::stat(path.c_str(), &st) < 0 || !S_ISREG(st.st_mode)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.erase(path);
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entry = entries_[path];
+        entry.checked_at = now;
+        //文件未变化时复用原有的元数据，避免重新格式化
+        if (entry.meta && entry.ino == st.st_ino && entry.meta->size == static_cast<size_t>(st.st_size)
+            && entry.mtime_ns == to_nanoseconds(st.st_mtim)) {
+            return entry.meta;
+        }
+
+        auto meta = std::make_shared<FileMeta>();
+        meta->size = st.st_size;
+        meta->mtime = st.st_mtim.tv_sec;
+        meta->etag = std::format("\"{:x}-{:x}-{:x}\"",
+            st.st_ino, st.st_size, to_nanoseconds(st.st_mtim));
+        meta->last_modified = format_http_date(st.st_mtim.tv_sec);
+
+        entry.ino = st.st_ino;
+        entry.mtime_ns = to_nanoseconds(st.st_mtim);
+        entry.meta = std::move(meta);
+        return entry.meta;
+    }
+
+    //设置重新校验间隔（为0时每次请求都会 stat()）
+    auto set_revalidate_interval(std::chrono::milliseconds interval) -> void{
+        std::lock_guard<std::mutex> lock(mutex_);
+        revalidate_interval_ = interval;
+    }
+
+private:
+    static auto to_nanoseconds(const timespec& ts) -> uint64_t{
+        return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + ts.tv_nsec;
+    }
+
+    struct Entry {
+        std::shared_ptr<const FileMeta> meta;
+        ino_t ino{0};
+        uint64_t mtime_ns{0};
+        std::chrono::steady_clock::time_point checked_at;
+    };
+
+    std::unordered_map<std::string, Entry> entries_;
+    std::chrono::milliseconds revalidate_interval_;
+    std::mutex mutex_;
+};
+
+//判断条件请求是否命中（返回 true 表示应回复 304）
+//If-None-Match 优先于 If-Modified-Since（RFC 7232 第6节）
+inline auto is_not_modified(const HttpRequest& request,
+                            std::string_view etag, std::time_t mtime) -> bool{
+    if (request.method != "GET" && request.method != "HEAD") {
+        return false;
+    }
+
+    if (auto inm = request.header("if-none-match"); !inm.empty()) {
+        //逐个比较逗号分隔的实体标签（弱比较：忽略 W/ 前缀）
+        if (etag.starts_with("W/")) etag.remove_prefix(2);
+        size_t start = 0;
+        while (start < inm.size()) {
+            size_t end = inm.find(',', start);
+            if (end == std::string_view::npos) end = inm.size();
+            auto tag = inm.substr(start, end - start);
+            while (!tag.empty() && tag.front() == ' ') tag.remove_prefix(1);
+            while (!tag.empty() && tag.back() == ' ') tag.remove_suffix(1);
+            if (tag.starts_with("W/")) tag.remove_prefix(2);
+            if (tag == "*" || tag == etag) {
+                return true;
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    if (auto ims = request.header("if-modified-since"); !ims.empty() && mtime > 0) {
+        auto since = parse_http_date(ims);
+        return since >= 0 && mtime <= since;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,828 @@
+#pragma once
+
+#include "saxio/net/http/h2/frame.hpp"
+#include "saxio/net/http/h2/hpack.hpp"
+#include "saxio/net/http/parser.hpp"
+#include "saxio/net.hpp"
+#include "saxio/common/debug.hpp"
+#include "saxio/common/util/base64.hpp"
+#include <sys/socket.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <map>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+namespace saxio::http::h2{
+
+namespace detail {
+
+//增量式 chunked 解码器：在非阻塞场景下按到达的数据逐段解码
+class ChunkedDecoder {
+public:
+    //解码 in 中的数据并追加到 out，格式错误时返回 false
+    auto feed(std::string_view in, std::string& out) -> bool{
+        size_t pos = 0;
+        while (pos < in.size() && state_ != State::DONE) {
+            if (state_ == State::DATA) {
+                size_t n = std::min(remaining_, in.size() - pos);
+                out.append(in.substr(pos, n));
+                pos += n;
+                remaining_ -= n;
+                if (remaining_ == 0) state_ = State::DATA_END;
+                continue;
+            }
+
+            //其余状态都按行处理
+            size_t end = in.find('\n', pos);
+            line_.append(in.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos));
+            if (end == std::string_view::npos) {
+                return line_.size() <= kMaxLineSize;
+            }
+            pos = end + 1;
+            if (!line_.empty() && line_.back() == '\r') line_.pop_back();
+
+            if (state_ == State::DATA_END) {
+                if (!line_.empty()) return false;
+                state_ = State::SIZE;
+            } else if (state_ == State::SIZE) {
+                std::string_view size_str{line_};
+                size_str = size_str.substr(0, size_str.find(';'));
+                auto [ptr, ec] = std::from_chars(size_str.data(), size_str.data() + size_str.size(), remaining_, 16);
+                if (ec != std::errc{} || size_str.empty()) return false;
+                state_ = remaining_ == 0 ? State::TRAILER : State::DATA;
+            } else if (line_.empty()) {
+                state_ = State::DONE;   //尾部字段以空行结束
+            }
+            line_.clear();
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    auto done() const noexcept -> bool{ return state_ == State::DONE; }
+
+private:
+    enum class State { SIZE, DATA, DATA_END, TRAILER, DONE };
+    static constexpr size_t kMaxLineSize = 4096;
+
+    State state_{State::SIZE};
+    size_t remaining_{0};
+    std::string line_;
+};
+
+}
+
+//HTTP/2 明文连接（h2c）：在一个 TCP 连接、一个线程上复用多个流。
+//每个流通过 socketpair 桥接到现有的 HTTP/1.1 处理流程（请求被转换成 HTTP/1.1 报文，
+//响应再被转换回 HEADERS/DATA 帧），因此所有处理器无需修改即可用于 HTTP/2
+class Connection {
+public:
+    //为一个流启动 HTTP/1.1 处理流程（参数为桥接 socket 的处理器一端）
+    using StreamSpawner = std::function<void(net::TcpStream)>;
+
+    static constexpr uint32_t kMaxConcurrentStreams = 100;     //允许的最大并发流数
+    static constexpr size_t kMaxActiveHandlers = 16;           //每个连接同时运行的处理器上限，其余的流排队
+    static constexpr uint32_t kStreamWindow = 256 * 1024;      //每个流的接收窗口
+    static constexpr uint32_t kConnectionWindow = 16 * 1024 * 1024;  //连接级接收窗口
+    static constexpr size_t kMaxOutputBuffer = 1024 * 1024;    //待发送数据超过该值时暂停读取
+    static constexpr size_t kMaxHeaderBlock = 64 * 1024;       //头部块最大长度
+
+    Connection(net::TcpStream& stream, StreamSpawner spawner, const std::atomic<bool>& running)
+        : stream_(stream), spawner_(std::move(spawner)), running_(running){}
+
+    //以 prior knowledge 方式运行连接
+    //initial 为已经读取到的数据，expected_preface 为其中仍需校验的连接序言部分
+    auto serve(std::string initial, std::string_view expected_preface = kConnectionPreface) -> void{
+        in_ = std::move(initial);
+        preface_expected_ = expected_preface;
+        run();
+    }
+
+    //处理 "Upgrade: h2c" 升级：回复 101 后把原请求作为流1处理
+    //HTTP2-Settings 不合法时返回 false 且不发送任何数据，调用方按 HTTP/1.1 继续处理
+    auto serve_upgrade(const HttpRequest& request, std::string initial) -> bool{
+        auto settings = util::base64_decode(request.header("http2-settings"));
+        if (!settings || settings->size() % 6 != 0) {
+            return false;
+        }
+
+        if (auto ret = stream_.write(
+                "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n"); !ret) {
+            LOG_ERROR("Send h2c upgrade response failed: {}", ret.error());
+            return true;
+        }
+        apply_settings(*settings);
+
+        //流1对应升级前的请求，客户端一侧已半关闭
+        std::string h1 = std::format("{} {} HTTP/1.1\r\n", request.method, request.path);
+        for (const auto& [name, value] : request.headers) {
+            if (name == "upgrade" || name == "http2-settings" || is_connection_header(name)) continue;
+            h1.append(name).append(": ").append(value).append("\r\n");
+        }
+        h1 += "\r\n";
+        last_stream_id_ = 1;
+        create_stream(1, std::move(h1), false, true, request.method == "HEAD");
+
+        in_ = std::move(initial);
+        preface_expected_ = kConnectionPreface;
+        run();
+        return true;
+    }
+
+private:
+    //响应体的分帧方式（来自处理器输出的 HTTP/1.1 响应头）
+    enum class BodyMode { NONE, LENGTH, CHUNKED, UNTIL_EOF };
+
+    struct Stream {
+        uint32_t id{0};
+        io::detail::FD bridge;        //连接一侧的桥接 socket
+        io::detail::FD handler_end;   //处理器一侧的桥接 socket，处理器排队期间由连接保存
+        bool head_request{false};
+
+        //请求方向：客户端 -> 处理器
+        std::string to_handler;       //等待写入处理器的 HTTP/1.1 数据
+        size_t unacked{0};            //已接收但尚未通过 WINDOW_UPDATE 归还的字节数
+        int64_t recv_window{kStreamWindow};
+        bool request_chunked{false};  //请求体是否以 chunked 形式转发给处理器
+        bool remote_closed{false};    //已收到 END_STREAM
+        bool input_shutdown{false};   //已关闭处理器的输入方向
+        bool handler_gone{false};     //处理器已关闭连接
+
+        //响应方向：处理器 -> 客户端
+        int64_t send_window{kDefaultWindowSize};
+        std::string response_head;    //正在累积的 HTTP/1.1 响应头
+        bool headers_sent{false};
+        BodyMode body_mode{BodyMode::NONE};
+        size_t body_remaining{0};
+        detail::ChunkedDecoder chunked;
+        std::string pending_body;     //已解码、等待发送窗口的响应体数据
+        bool body_complete{false};
+        bool bridge_eof{false};
+        bool end_stream_sent{false};
+        bool reset{false};            //已发送 RST_STREAM
+    };
+
+    //连接相关的头部在 HTTP/2 中被禁止（RFC 7540 8.1.2.2）
+    static auto is_connection_header(std::string_view name) -> bool{
+        return name == "connection" || name == "keep-alive" || name == "proxy-connection"
+            || name == "transfer-encoding" || name == "upgrade";
+    }
+
+    //主循环：poll 客户端连接和所有流的桥接 socket
+    auto run() -> void{
+        int client_fd = stream_.fd();
+        int flags = fcntl(client_fd, F_GETFL, 0);
+        if (flags == -1 || fcntl(client_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+            LOG_ERROR("Set h2 connection non-block failed: {}", client_fd);
+            return;
+        }
+        LOG_INFO("HTTP/2 connection started: {}", client_fd);
+
+        //服务器的连接序言：SETTINGS 帧，并放大连接级接收窗口
+        append_settings(out_, {
+            {SettingsId::MAX_CONCURRENT_STREAMS, kMaxConcurrentStreams},
+            {SettingsId::INITIAL_WINDOW_SIZE, kStreamWindow},
+        });
+        append_window_update(out_, 0, kConnectionWindow - kDefaultWindowSize);
+        process_input();
+
+        std::vector<pollfd> fds;
+        std::vector<uint32_t> ids;
+        char buf[16 * 1024];
+        while (!peer_gone_) {
+            for (auto& [id, s] : streams_) flush_response_data(*s);
+            sweep_streams();
+            start_handlers();
+            flush_output();
+            if (peer_gone_ || (closing_ && pending_output() == 0)) break;
+            if (goaway_received_ && streams_.empty() && pending_output() == 0) break;
+
+            fds.clear();
+            ids.clear();
+            short client_events = 0;
+            if (!closing_ && pending_output() < kMaxOutputBuffer) client_events |= POLLIN;
+            if (pending_output() > 0) client_events |= POLLOUT;
+            fds.push_back({client_fd, client_events, 0});
+            for (auto& [id, s] : streams_) {
+                short events = 0;
+                if (wants_response_data(*s)) events |= POLLIN;
+                if (!s->to_handler.empty() && !s->handler_gone) events |= POLLOUT;
+                if (events == 0) continue;
+                fds.push_back({s->bridge.fd(), events, 0});
+                ids.push_back(id);
+            }
+
+            if (::poll(fds.data(), fds.size(), 1000) < 0 && errno != EINTR) {
+                LOG_ERROR("h2 poll failed: {}", strerror(errno));
+                break;
+            }
+            if (!running_ && !closing_) {
+                append_goaway(out_, last_stream_id_, ErrorCode::NO_ERROR);
+                closing_ = true;
+            }
+
+            if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+                auto n = ::read(client_fd, buf, sizeof(buf));
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                    LOG_INFO("HTTP/2 client closed connection: {}", client_fd);
+                    break;
+                }
+                if (n > 0) {
+                    in_.append(buf, n);
+                    process_input();
+                }
+            }
+
+            for (size_t i = 1; i < fds.size(); ++i) {
+                auto it = streams_.find(ids[i - 1]);
+                if (it == streams_.end() || fds[i].revents == 0) continue;
+                if (fds[i].revents & POLLOUT) write_to_handler(*it->second);
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_from_handler(*it->second);
+            }
+        }
+        LOG_INFO("HTTP/2 connection finished: {}, last stream {}", client_fd, last_stream_id_);
+    }
+
+    [[nodiscard]]
+    auto pending_output() const noexcept -> size_t{ return out_.size() - out_sent_; }
+
+    //尽可能多地把待发送数据写入客户端（非阻塞）
+    auto flush_output() -> void{
+        while (out_sent_ < out_.size()) {
+            auto n = ::send(stream_.fd(), out_.data() + out_sent_, out_.size() - out_sent_, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) peer_gone_ = true;
+                break;
+            }
+            out_sent_ += n;
+        }
+        if (out_sent_ == out_.size()) {
+            out_.clear();
+            out_sent_ = 0;
+        } else if (out_sent_ > 64 * 1024) {
+            out_.erase(0, out_sent_);
+            out_sent_ = 0;
+        }
+    }
+
+    //连接错误：发送 GOAWAY 后关闭连接
+    auto fail(ErrorCode code) -> bool{
+        LOG_WARN("HTTP/2 connection error {} on fd {}", static_cast<uint32_t>(code), stream_.fd());
+        if (!closing_) append_goaway(out_, last_stream_id_, code);
+        closing_ = true;
+        return false;
+    }
+
+    //流错误：只重置单个流
+    auto reset_stream(Stream& s, ErrorCode code) -> void{
+        if (!s.reset) append_rst_stream(out_, s.id, code);
+        s.reset = true;
+    }
+
+    //解析已收到的数据中所有完整的帧
+    auto process_input() -> void{
+        if (!preface_expected_.empty()) {
+            size_t n = std::min(in_.size(), preface_expected_.size());
+            if (in_.compare(0, n, preface_expected_, 0, n) != 0) {
+                fail(ErrorCode::PROTOCOL_ERROR);
+                return;
+            }
+            in_.erase(0, n);
+            preface_expected_.erase(0, n);
+            if (!preface_expected_.empty()) return;
+        }
+
+        size_t pos = 0;
+        while (!closing_ && in_.size() - pos >= kFrameHeaderSize) {
+            FrameHeader header = parse_frame_header(in_.data() + pos);
+            if (header.length > kDefaultMaxFrameSize) {
+                fail(ErrorCode::FRAME_SIZE_ERROR);
+                break;
+            }
+            if (in_.size() - pos < kFrameHeaderSize + header.length) break;
+            std::string_view payload{in_.data() + pos + kFrameHeaderSize, header.length};
+            pos += kFrameHeaderSize + header.length;
+            if (!handle_frame(header, payload)) break;
+        }
+        in_.erase(0, pos);
+    }
+
+    auto handle_frame(const FrameHeader& header, std::string_view payload) -> bool{
+        //头部块必须由连续的 CONTINUATION 帧完成，中间不能插入其它帧
+        if (header_stream_id_ != 0 && (header.type != FrameType::CONTINUATION
+                                       || header.stream_id != header_stream_id_)) {
+            return fail(ErrorCode::PROTOCOL_ERROR);
+        }
+
+        switch (header.type) {
+            case FrameType::DATA:
+                return on_data(header, payload);
+            case FrameType::HEADERS:
+                return on_headers(header, payload);
+            case FrameType::PRIORITY:
+                //不实现优先级调度
+                return header.stream_id != 0 || fail(ErrorCode::PROTOCOL_ERROR);
+            case FrameType::RST_STREAM:
+                if (header.length != 4) return fail(ErrorCode::FRAME_SIZE_ERROR);
+                if (header.stream_id == 0) return fail(ErrorCode::PROTOCOL_ERROR);
+                if (auto it = streams_.find(header.stream_id); it != streams_.end()) {
+                    LOG_DEBUG("HTTP/2 stream {} reset by peer", header.stream_id);
+                    streams_.erase(it);   //关闭桥接 socket，处理器随之结束
+                }
+                return true;
+            case FrameType::SETTINGS:
+                return on_settings(header, payload);
+            case FrameType::PUSH_PROMISE:
+                //客户端不能推送
+                return fail(ErrorCode::PROTOCOL_ERROR);
+            case FrameType::PING:
+                if (header.length != 8) return fail(ErrorCode::FRAME_SIZE_ERROR);
+                if (header.stream_id != 0) return fail(ErrorCode::PROTOCOL_ERROR);
+                if (!(header.flags & flags::kAck)) {
+                    append_frame(out_, FrameType::PING, flags::kAck, 0, payload);
+                }
+                return true;
+            case FrameType::GOAWAY:
+                goaway_received_ = true;
+                return true;
+            case FrameType::WINDOW_UPDATE:
+                return on_window_update(header, payload);
+            case FrameType::CONTINUATION:
+                if (header_stream_id_ == 0) return fail(ErrorCode::PROTOCOL_ERROR);
+                if (header_block_.size() + payload.size() > kMaxHeaderBlock) {
+                    return fail(ErrorCode::PROTOCOL_ERROR);
+                }
+                header_block_.append(payload);
+                if (header.flags & flags::kEndHeaders) return finish_headers();
+                return true;
+            default:
+                //未知类型的帧必须忽略
+                return true;
+        }
+    }
+
+    //去掉填充字节，填充长度非法时返回 false
+    static auto strip_padding(const FrameHeader& header, std::string_view& payload) -> bool{
+        if (!(header.flags & flags::kPadded)) return true;
+        if (payload.empty()) return false;
+        size_t pad_length = static_cast<uint8_t>(payload[0]);
+        payload.remove_prefix(1);
+        if (pad_length > payload.size()) return false;
+        payload.remove_suffix(pad_length);
+        return true;
+    }
+
+    auto on_headers(const FrameHeader& header, std::string_view payload) -> bool{
+        if (header.stream_id == 0 || header.stream_id % 2 == 0) {
+            return fail(ErrorCode::PROTOCOL_ERROR);
+        }
+        if (!strip_padding(header, payload)) return fail(ErrorCode::PROTOCOL_ERROR);
+        if (header.flags & flags::kPriority) {
+            if (payload.size() < 5) return fail(ErrorCode::FRAME_SIZE_ERROR);
+            payload.remove_prefix(5);
+        }
+
+        header_stream_id_ = header.stream_id;
+        header_end_stream_ = header.flags & flags::kEndStream;
+        header_block_.assign(payload);
+        if (header.flags & flags::kEndHeaders) return finish_headers();
+        return true;
+    }
+
+    //头部块接收完成：解码后新建流，或作为已有流的尾部字段
+    auto finish_headers() -> bool{
+        uint32_t id = header_stream_id_;
+        header_stream_id_ = 0;
+
+        HeaderBlock fields;
+        if (!decoder_.decode(header_block_, fields)) {
+            return fail(ErrorCode::COMPRESSION_ERROR);
+        }
+
+        if (auto it = streams_.find(id); it != streams_.end()) {
+            //尾部字段（trailers）必须结束流，内容不转发给处理器
+            Stream& s = *it->second;
+            if (s.remote_closed || !header_end_stream_) {
+                reset_stream(s, ErrorCode::PROTOCOL_ERROR);
+                return true;
+            }
+            on_remote_end(s);
+            write_to_handler(s);
+            return true;
+        }
+
+        if (id <= last_stream_id_) return fail(ErrorCode::STREAM_CLOSED);
+        last_stream_id_ = id;
+        if (closing_ || goaway_received_) return true;
+        if (streams_.size() >= kMaxConcurrentStreams) {
+            append_rst_stream(out_, id, ErrorCode::REFUSED_STREAM);
+            return true;
+        }
+
+        //把伪头部和普通头部转换为 HTTP/1.1 请求头
+        std::string method, path, authority, cookie, lines;
+        bool has_length = false, has_host = false;
+        for (auto& [name, value] : fields) {
+            if (name == ":method") method = value;
+            else if (name == ":path") path = value;
+            else if (name == ":authority") authority = value;
+            else if (name.starts_with(':')) continue;
+            else if (name == "cookie") {
+                //HTTP/2 允许把 Cookie 拆成多个字段，转发时重新用 "; " 连接
+                if (!cookie.empty()) cookie += "; ";
+                cookie += value;
+            } else if (is_connection_header(name) || name == "te" || name == "http2-settings") {
+                continue;
+            } else {
+                has_length = has_length || name == "content-length";
+                has_host = has_host || name == "host";
+                lines.append(name).append(": ").append(value).append("\r\n");
+            }
+        }
+        if (method.empty() || path.empty()) {
+            append_rst_stream(out_, id, ErrorCode::PROTOCOL_ERROR);
+            return true;
+        }
+
+        std::string h1 = std::format("{} {} HTTP/1.1\r\n", method, path);
+        if (!authority.empty() && !has_host) h1.append("host: ").append(authority).append("\r\n");
+        h1 += lines;
+        if (!cookie.empty()) h1.append("cookie: ").append(cookie).append("\r\n");
+        //长度未知的请求体以 chunked 形式转发
+        bool chunked = !header_end_stream_ && !has_length;
+        if (chunked) h1 += "transfer-encoding: chunked\r\n";
+        h1 += "\r\n";
+
+        LOG_DEBUG("HTTP/2 stream {}: {} {}", id, method, path);
+        create_stream(id, std::move(h1), chunked, header_end_stream_, method == "HEAD");
+        return true;
+    }
+
+    //新建流：创建 socketpair，处理器一端由 start_handlers() 交给 HTTP/1.1 处理流程
+    auto create_stream(uint32_t id, std::string h1_request, bool chunked,
+                       bool end_stream, bool head_request) -> void{
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0) {
+            LOG_ERROR("Create h2 stream bridge failed: {}", strerror(errno));
+            append_rst_stream(out_, id, ErrorCode::INTERNAL_ERROR);
+            return;
+        }
+        int flags = fcntl(fds[0], F_GETFL, 0);
+        fcntl(fds[0], F_SETFL, flags | O_NONBLOCK);
+
+        auto s = std::make_unique<Stream>();
+        s->id = id;
+        s->bridge = io::detail::FD{fds[0]};
+        s->head_request = head_request;
+        s->to_handler = std::move(h1_request);
+        s->request_chunked = chunked;
+        s->send_window = peer_initial_window_;
+        s->handler_end = io::detail::FD{fds[1]};
+        if (end_stream) on_remote_end(*s);
+
+        //处理器启动前请求数据先写入 socket 缓冲区，超出部分留在 to_handler 中受流量控制约束
+        write_to_handler(*s);
+        streams_.emplace(id, std::move(s));
+        start_handlers();
+    }
+
+    //按流编号顺序为排队的流启动处理器，运行中的处理器数不超过 kMaxActiveHandlers
+    //
+    //每个处理器占用一个线程，一个连接的 100 个并发流不应占用 100 个线程。
+    //处理器关闭桥接 socket（bridge_eof）或流被移除后让出名额。
+    auto start_handlers() -> void{
+        size_t active = 0;
+        for (auto& [id, s] : streams_) {
+            if (!s->handler_end.is_valid() && !s->bridge_eof) ++active;
+        }
+        for (auto& [id, s] : streams_) {
+            if (active >= kMaxActiveHandlers) break;
+            if (!s->handler_end.is_valid() || s->reset) continue;
+            spawner_(net::TcpStream{net::detail::Socket{s->handler_end.release()}});
+            ++active;
+        }
+    }
+
+    auto on_data(const FrameHeader& header, std::string_view payload) -> bool{
+        if (header.stream_id == 0) return fail(ErrorCode::PROTOCOL_ERROR);
+        size_t flow_length = header.length;   //填充也计入流量控制
+        if (!strip_padding(header, payload)) return fail(ErrorCode::PROTOCOL_ERROR);
+
+        //连接级窗口立即归还：每个流的缓冲量已由流级窗口限制
+        if (flow_length > 0) append_window_update(out_, 0, flow_length);
+
+        auto it = streams_.find(header.stream_id);
+        if (it == streams_.end() || it->second->remote_closed) {
+            if (header.stream_id > last_stream_id_) return fail(ErrorCode::PROTOCOL_ERROR);
+            append_rst_stream(out_, header.stream_id, ErrorCode::STREAM_CLOSED);
+            return true;
+        }
+
+        Stream& s = *it->second;
+        s.recv_window -= flow_length;
+        if (s.recv_window < 0) {
+            reset_stream(s, ErrorCode::FLOW_CONTROL_ERROR);
+            return true;
+        }
+        s.unacked += flow_length;
+        if (!s.handler_gone && !payload.empty()) {
+            if (s.request_chunked) {
+                s.to_handler += std::format("{:x}\r\n", payload.size());
+                s.to_handler.append(payload);
+                s.to_handler += "\r\n";
+            } else {
+                s.to_handler.append(payload);
+            }
+        }
+        if (header.flags & flags::kEndStream) on_remote_end(s);
+        write_to_handler(s);
+        return true;
+    }
+
+    //客户端结束了请求方向
+    auto on_remote_end(Stream& s) -> void{
+        s.remote_closed = true;
+        if (s.request_chunked && !s.handler_gone) s.to_handler += "0\r\n\r\n";
+    }
+
+    auto on_settings(const FrameHeader& header, std::string_view payload) -> bool{
+        if (header.stream_id != 0) return fail(ErrorCode::PROTOCOL_ERROR);
+        if (header.flags & flags::kAck) {
+            return header.length == 0 || fail(ErrorCode::FRAME_SIZE_ERROR);
+        }
+        if (header.length % 6 != 0) return fail(ErrorCode::FRAME_SIZE_ERROR);
+        if (!apply_settings(payload)) return false;
+        append_frame(out_, FrameType::SETTINGS, flags::kAck, 0, {});
+        return true;
+    }
+
+    //应用对端的 SETTINGS 参数
+    auto apply_settings(std::string_view payload) -> bool{
+        for (size_t pos = 0; pos + 6 <= payload.size(); pos += 6) {
+            auto id = static_cast<SettingsId>(read_u16(payload.data() + pos));
+            uint32_t value = read_u32(payload.data() + pos + 2);
+            if (id == SettingsId::INITIAL_WINDOW_SIZE) {
+                if (value > kMaxWindowSize) return fail(ErrorCode::FLOW_CONTROL_ERROR);
+                //调整所有流的发送窗口（RFC 7540 6.9.2）
+                int64_t delta = static_cast<int64_t>(value) - peer_initial_window_;
+                for (auto& [stream_id, s] : streams_) s->send_window += delta;
+                peer_initial_window_ = value;
+            } else if (id == SettingsId::MAX_FRAME_SIZE) {
+                if (value < kDefaultMaxFrameSize || value > 0xffffff) return fail(ErrorCode::PROTOCOL_ERROR);
+                peer_max_frame_size_ = value;
+            }
+            //HEADER_TABLE_SIZE 不影响本端编码器（不使用动态表），其余参数忽略
+        }
+        return true;
+    }
+
+    auto on_window_update(const FrameHeader& header, std::string_view payload) -> bool{
+        if (header.length != 4) return fail(ErrorCode::FRAME_SIZE_ERROR);
+        uint32_t increment = read_u32(payload.data()) & 0x7fffffff;
+
+        if (header.stream_id == 0) {
+            if (increment == 0) return fail(ErrorCode::PROTOCOL_ERROR);
+            conn_send_window_ += increment;
+            if (conn_send_window_ > kMaxWindowSize) return fail(ErrorCode::FLOW_CONTROL_ERROR);
+            return true;
+        }
+        if (auto it = streams_.find(header.stream_id); it != streams_.end()) {
+            Stream& s = *it->second;
+            if (increment == 0) {
+                reset_stream(s, ErrorCode::PROTOCOL_ERROR);
+                return true;
+            }
+            s.send_window += increment;
+            if (s.send_window > kMaxWindowSize) reset_stream(s, ErrorCode::FLOW_CONTROL_ERROR);
+        }
+        return true;
+    }
+
+    //把请求数据写入处理器，并按处理器的消费进度归还流级窗口
+    auto write_to_handler(Stream& s) -> void{
+        while (!s.to_handler.empty() && !s.handler_gone) {
+            auto n = ::send(s.bridge.fd(), s.to_handler.data(), s.to_handler.size(), MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                s.handler_gone = true;   //处理器不再读取（例如已经返回了错误响应）
+                break;
+            }
+            s.to_handler.erase(0, n);
+        }
+        if (s.handler_gone) s.to_handler.clear();
+
+        if (s.unacked > 0 && !s.remote_closed && s.to_handler.size() < kStreamWindow / 2) {
+            append_window_update(out_, s.id, s.unacked);
+            s.recv_window += s.unacked;
+            s.unacked = 0;
+        }
+        if (s.to_handler.empty() && s.remote_closed && !s.input_shutdown) {
+            ::shutdown(s.bridge.fd(), SHUT_WR);
+            s.input_shutdown = true;
+        }
+    }
+
+    //是否需要从处理器读取响应数据（发送窗口和输出缓冲提供背压）
+    [[nodiscard]]
+    auto wants_response_data(const Stream& s) const -> bool{
+        if (s.bridge_eof || s.reset || !s.pending_body.empty()) return false;
+        //收到客户端连接序言（及其 SETTINGS）之前不发送响应，升级时 101 之后只紧跟服务器的 SETTINGS
+        if (!preface_expected_.empty()) return false;
+        if (pending_output() >= kMaxOutputBuffer) return false;
+        return !s.headers_sent || s.body_mode == BodyMode::NONE
+            || (s.send_window > 0 && conn_send_window_ > 0);
+    }
+
+    auto read_from_handler(Stream& s) -> void{
+        char buf[16 * 1024];
+        size_t want = sizeof(buf);
+        if (s.headers_sent && s.body_mode != BodyMode::NONE) {
+            want = static_cast<size_t>(std::min<int64_t>({
+                static_cast<int64_t>(want), s.send_window, conn_send_window_}));
+            if (want == 0) return;
+        }
+
+        auto n = ::recv(s.bridge.fd(), buf, want, MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+        if (n <= 0) {
+            s.bridge_eof = true;
+            on_handler_eof(s);
+            return;
+        }
+        on_response_bytes(s, {buf, static_cast<size_t>(n)});
+    }
+
+    //处理器输出的 HTTP/1.1 响应数据：先解析响应头，之后按分帧方式解码响应体
+    auto on_response_bytes(Stream& s, std::string_view data) -> void{
+        if (!s.headers_sent) {
+            s.response_head.append(data);
+            while (true) {
+                auto pos = s.response_head.find("\r\n\r\n");
+                if (pos == std::string::npos) {
+                    if (s.response_head.size() > kMaxHeaderSize) reset_stream(s, ErrorCode::INTERNAL_ERROR);
+                    return;
+                }
+                HttpResponse response = parse_http_response(std::string_view(s.response_head).substr(0, pos + 4));
+                if (response.status == 0) {
+                    reset_stream(s, ErrorCode::INTERNAL_ERROR);
+                    return;
+                }
+                std::string rest = s.response_head.substr(pos + 4);
+                s.response_head.clear();
+                //丢弃 1xx 中间响应（如 100 Continue），HTTP/2 中由流量控制代替
+                if (response.status >= 100 && response.status < 200) {
+                    s.response_head = std::move(rest);
+                    continue;
+                }
+                send_response_headers(s, response);
+                if (!rest.empty()) append_body(s, rest);
+                return;
+            }
+        }
+        append_body(s, data);
+    }
+
+    auto append_body(Stream& s, std::string_view data) -> void{
+        switch (s.body_mode) {
+            case BodyMode::NONE:
+                break;
+            case BodyMode::LENGTH: {
+                size_t n = std::min(data.size(), s.body_remaining);
+                s.pending_body.append(data.substr(0, n));
+                s.body_remaining -= n;
+                if (s.body_remaining == 0) s.body_complete = true;
+                break;
+            }
+            case BodyMode::CHUNKED:
+                if (!s.chunked.feed(data, s.pending_body)) {
+                    reset_stream(s, ErrorCode::INTERNAL_ERROR);
+                    return;
+                }
+                if (s.chunked.done()) s.body_complete = true;
+                break;
+            case BodyMode::UNTIL_EOF:
+                s.pending_body.append(data);
+                break;
+        }
+    }
+
+    //把 HTTP/1.1 响应头编码为 HEADERS（以及必要的 CONTINUATION）帧
+    auto send_response_headers(Stream& s, const HttpResponse& response) -> void{
+        HeaderBlock block;
+        block.push_back({":status", std::to_string(response.status)});
+        //逐个字段编码，多个 Set-Cookie 各占一项，不能像其他头部那样用逗号合并
+        for (const auto& [name, value] : response.fields) {
+            if (is_connection_header(name)) continue;
+            block.push_back({name, value});
+        }
+
+        if (s.head_request || response.status == 204 || response.status == 304) {
+            s.body_mode = BodyMode::NONE;
+        } else if (header_has_token(response.header("transfer-encoding"), "chunked")) {
+            s.body_mode = BodyMode::CHUNKED;
+        } else if (auto length = parse_content_length(response.header("content-length"))) {
+            s.body_mode = BodyMode::LENGTH;
+            s.body_remaining = length.value();
+        } else {
+            s.body_mode = BodyMode::UNTIL_EOF;
+        }
+        s.body_complete = s.body_mode == BodyMode::NONE
+            || (s.body_mode == BodyMode::LENGTH && s.body_remaining == 0);
+
+        std::string encoded;
+        encoder_.encode(block, encoded);
+        std::string_view rest{encoded};
+        bool first = true;
+        do {
+            auto fragment = rest.substr(0, peer_max_frame_size_);
+            rest.remove_prefix(fragment.size());
+            uint8_t frame_flags = rest.empty() ? flags::kEndHeaders : 0;
+            if (first && s.body_complete) frame_flags |= flags::kEndStream;
+            append_frame(out_, first ? FrameType::HEADERS : FrameType::CONTINUATION,
+                         frame_flags, s.id, fragment);
+            first = false;
+        } while (!rest.empty());
+
+        s.headers_sent = true;
+        s.end_stream_sent = s.body_complete;
+    }
+
+    //按发送窗口把响应体封装为 DATA 帧
+    auto flush_response_data(Stream& s) -> void{
+        if (s.reset || !s.headers_sent || s.end_stream_sent) return;
+        while (!s.pending_body.empty() && s.send_window > 0 && conn_send_window_ > 0
+               && pending_output() < kMaxOutputBuffer) {
+            size_t n = static_cast<size_t>(std::min<int64_t>({
+                static_cast<int64_t>(s.pending_body.size()), s.send_window,
+                conn_send_window_, static_cast<int64_t>(peer_max_frame_size_)}));
+            bool last = s.body_complete && n == s.pending_body.size();
+            append_frame(out_, FrameType::DATA, last ? flags::kEndStream : 0,
+                         s.id, std::string_view(s.pending_body).substr(0, n));
+            s.pending_body.erase(0, n);
+            s.send_window -= n;
+            conn_send_window_ -= n;
+            s.end_stream_sent = last;
+        }
+        if (s.body_complete && s.pending_body.empty() && !s.end_stream_sent) {
+            append_frame(out_, FrameType::DATA, flags::kEndStream, s.id, {});
+            s.end_stream_sent = true;
+        }
+    }
+
+    //处理器关闭了连接
+    auto on_handler_eof(Stream& s) -> void{
+        if (!s.headers_sent) {
+            reset_stream(s, ErrorCode::INTERNAL_ERROR);
+        } else if (s.body_mode == BodyMode::UNTIL_EOF) {
+            s.body_complete = true;
+        } else if (!s.body_complete) {
+            //响应体被截断
+            reset_stream(s, ErrorCode::INTERNAL_ERROR);
+        }
+    }
+
+    //移除已经结束的流
+    auto sweep_streams() -> void{
+        std::erase_if(streams_, [this](const auto& item) {
+            Stream& s = *item.second;
+            if (s.reset) return true;
+            if (!s.end_stream_sent) return false;
+            //响应已完成而客户端仍在发送请求体时，通知其停止（RFC 7540 8.1）
+            if (!s.remote_closed) append_rst_stream(out_, s.id, ErrorCode::NO_ERROR);
+            return true;
+        });
+    }
+
+    net::TcpStream& stream_;
+    StreamSpawner spawner_;
+    const std::atomic<bool>& running_;
+
+    std::string in_;                  //已接收但尚未解析的数据
+    std::string out_;                 //待发送的帧
+    size_t out_sent_{0};              //out_ 中已发送的字节数
+    std::string preface_expected_;    //尚未收到的连接序言部分
+
+    HpackDecoder decoder_;
+    HpackEncoder encoder_;
+    std::map<uint32_t, std::unique_ptr<Stream>> streams_;
+    uint32_t last_stream_id_{0};
+
+    uint32_t header_stream_id_{0};    //正在接收头部块的流（0表示没有）
+    bool header_end_stream_{false};
+    std::string header_block_;
+
+    int64_t conn_send_window_{kDefaultWindowSize};
+    int64_t peer_initial_window_{kDefaultWindowSize};
+    uint32_t peer_max_frame_size_{kDefaultMaxFrameSize};
+    bool goaway_received_{false};
+    bool closing_{false};             //已发送 GOAWAY，发送完缓冲数据后关闭
+    bool peer_gone_{false};
+};
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <utility>
+#include <initializer_list>
+
+namespace saxio::http::h2{
+
+//客户端连接序言（RFC 7540 3.5）
+inline constexpr std::string_view kConnectionPreface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+//帧头长度
+inline constexpr size_t kFrameHeaderSize = 9;
+
+//协议规定的默认值
+inline constexpr uint32_t kDefaultWindowSize = 65535;
+inline constexpr uint32_t kDefaultMaxFrameSize = 16384;
+inline constexpr int64_t kMaxWindowSize = 0x7fffffff;
+
+//帧类型
+enum class FrameType : uint8_t {
+    DATA = 0x0,
+    HEADERS = 0x1,
+    PRIORITY = 0x2,
+    RST_STREAM = 0x3,
+    SETTINGS = 0x4,
+    PUSH_PROMISE = 0x5,
+    PING = 0x6,
+    GOAWAY = 0x7,
+    WINDOW_UPDATE = 0x8,
+    CONTINUATION = 0x9,
+};
+
+//帧标志位
+namespace flags {
+inline constexpr uint8_t kEndStream = 0x1;
+inline constexpr uint8_t kAck = 0x1;
+inline constexpr uint8_t kEndHeaders = 0x4;
+inline constexpr uint8_t kPadded = 0x8;
+inline constexpr uint8_t kPriority = 0x20;
+}
+
+//错误码（RST_STREAM / GOAWAY）
+enum class ErrorCode : uint32_t {
+    NO_ERROR = 0x0,
+    PROTOCOL_ERROR = 0x1,
+    INTERNAL_ERROR = 0x2,
+    FLOW_CONTROL_ERROR = 0x3,
+    SETTINGS_TIMEOUT = 0x4,
+    STREAM_CLOSED = 0x5,
+    FRAME_SIZE_ERROR = 0x6,
+    REFUSED_STREAM = 0x7,
+    CANCEL = 0x8,
+    COMPRESSION_ERROR = 0x9,
+};
+
+//SETTINGS 参数
+enum class SettingsId : uint16_t {
+    HEADER_TABLE_SIZE = 0x1,
+    ENABLE_PUSH = 0x2,
+    MAX_CONCURRENT_STREAMS = 0x3,
+    INITIAL_WINDOW_SIZE = 0x4,
+    MAX_FRAME_SIZE = 0x5,
+    MAX_HEADER_LIST_SIZE = 0x6,
+};
+
+//帧头
+struct FrameHeader {
+    uint32_t length{0};     //负载长度（24位）
+    FrameType type{FrameType::DATA};
+    uint8_t flags{0};
+    uint32_t stream_id{0};  //流标识（31位）
+};
+
+//按网络字节序读取整数
+inline auto read_u16(const char* p) -> uint16_t{
+    return static_cast<uint16_t>(static_cast<uint8_t>(p[0]) << 8 | static_cast<uint8_t>(p[1]));
+}
+
+inline auto read_u32(const char* p) -> uint32_t{
+    return static_cast<uint32_t>(static_cast<uint8_t>(p[0])) << 24
+         | static_cast<uint32_t>(static_cast<uint8_t>(p[1])) << 16
+         | static_cast<uint32_t>(static_cast<uint8_t>(p[2])) << 8
+         | static_cast<uint32_t>(static_cast<uint8_t>(p[3]));
+}
+
+inline auto append_u16(std::string& out, uint16_t value) -> void{
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+
+inline auto append_u32(std::string& out, uint32_t value) -> void{
+    out += static_cast<char>(value >> 24);
+    out += static_cast<char>(value >> 16);
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value);
+}
+
+//解析帧头（调用方保证至少有 kFrameHeaderSize 个字节）
+inline auto parse_frame_header(const char* p) -> FrameHeader{
+    FrameHeader header;
+    header.length = static_cast<uint32_t>(static_cast<uint8_t>(p[0])) << 16
+                  | static_cast<uint32_t>(static_cast<uint8_t>(p[1])) << 8
+                  | static_cast<uint32_t>(static_cast<uint8_t>(p[2]));
+    header.type = static_cast<FrameType>(p[3]);
+    header.flags = static_cast<uint8_t>(p[4]);
+    header.stream_id = read_u32(p + 5) & 0x7fffffff;
+    return header;
+}
+
+//追加一个完整的帧
+inline auto append_frame(std::string& out, FrameType type, uint8_t frame_flags,
+                         uint32_t stream_id, std::string_view payload) -> void{
+    out += static_cast<char>(payload.size() >> 16);
+    out += static_cast<char>(payload.size() >> 8);
+    out += static_cast<char>(payload.size());
+    out += static_cast<char>(type);
+    out += static_cast<char>(frame_flags);
+    append_u32(out, stream_id & 0x7fffffff);
+    out.append(payload);
+}
+
+inline auto append_settings(std::string& out,
+                            std::initializer_list<std::pair<SettingsId, uint32_t>> settings) -> void{
+    std::string payload;
+    for (const auto& [id, value] : settings) {
+        append_u16(payload, static_cast<uint16_t>(id));
+        append_u32(payload, value);
+    }
+    append_frame(out, FrameType::SETTINGS, 0, 0, payload);
+}
+
+inline auto append_window_update(std::string& out, uint32_t stream_id, uint32_t increment) -> void{
+    std::string payload;
+    append_u32(payload, increment & 0x7fffffff);
+    append_frame(out, FrameType::WINDOW_UPDATE, 0, stream_id, payload);
+}
+
+inline auto append_rst_stream(std::string& out, uint32_t stream_id, ErrorCode code) -> void{
+    std::string payload;
+    append_u32(payload, static_cast<uint32_t>(code));
+    append_frame(out, FrameType::RST_STREAM, 0, stream_id, payload);
+}
+
+inline auto append_goaway(std::string& out, uint32_t last_stream_id, ErrorCode code) -> void{
+    std::string payload;
+    append_u32(payload, last_stream_id & 0x7fffffff);
+    append_u32(payload, static_cast<uint32_t>(code));
+    append_frame(out, FrameType::GOAWAY, 0, 0, payload);
+}
+
+}
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace saxio::http::h2{
+
+//头部字段（名称统一为小写）
+struct HeaderField {
+    std::string name;
+    std::string value;
+};
+using HeaderBlock = std::vector<HeaderField>;
+
+namespace detail {
+
+//RFC 7541 附录B：Huffman 编码表（不含 EOS）
+inline constexpr uint32_t kHuffmanCodes[256] = {
+    0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+    0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+    0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+    0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+    0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+    0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+    0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+    0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+    0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+    0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+    0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+    0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+    0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+    0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+    0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+    0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+    0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+    0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+    0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+    0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+    0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+    0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+    0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+    0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+    0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+    0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+    0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+    0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+    0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+    0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+};
+inline constexpr uint8_t kHuffmanCodeLengths[256] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+};
+
+//EOS 符号的编码
+inline constexpr uint32_t kHuffmanEos = 0x3fffffff;
+inline constexpr uint8_t kHuffmanEosLength = 30;
+
+//RFC 7541 附录A：静态表（索引从1开始）
+inline constexpr std::pair<std::string_view, std::string_view> kStaticTable[61] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+
+//Huffman 解码树：由编码表在首次使用时构建，解码时按位遍历
+class HuffmanTree {
+public:
+    static auto instance() -> const HuffmanTree&{
+        static const HuffmanTree tree;
+        return tree;
+    }
+
+    //解码，填充位必须是不超过7位的 EOS 前缀（全1），否则视为错误
+    auto decode(std::string_view in, std::string& out) const -> bool{
+        int node = 0;
+        int bits_since_symbol = 0;
+        bool all_ones = true;
+        for (unsigned char byte : in) {
+            for (int i = 7; i >= 0; --i) {
+                int bit = byte >> i & 1;
+                node = nodes_[node].child[bit];
+                if (node <= 0) return false;
+                ++bits_since_symbol;
+                all_ones = all_ones && bit == 1;
+                if (int symbol = nodes_[node].symbol; symbol >= 0) {
+                    if (symbol == 256) return false;  //EOS 不允许出现在字符串中
+                    out += static_cast<char>(symbol);
+                    node = 0;
+                    bits_since_symbol = 0;
+                    all_ones = true;
+                }
+            }
+        }
+        return bits_since_symbol < 8 && all_ones;
+    }
+
+private:
+    HuffmanTree(){
+        nodes_.reserve(520);
+        nodes_.push_back({});
+        for (int symbol = 0; symbol <= 256; ++symbol) {
+            uint32_t code = symbol < 256 ? kHuffmanCodes[symbol] : kHuffmanEos;
+            int length = symbol < 256 ? kHuffmanCodeLengths[symbol] : kHuffmanEosLength;
+            int node = 0;
+            for (int i = length - 1; i >= 0; --i) {
+                int bit = code >> i & 1;
+                if (nodes_[node].child[bit] == 0) {
+                    nodes_[node].child[bit] = static_cast<int>(nodes_.size());
+                    nodes_.push_back({});
+                }
+                node = nodes_[node].child[bit];
+            }
+            nodes_[node].symbol = symbol;
+        }
+    }
+
+    struct Node {
+        int child[2]{0, 0};   //0 表示不存在（根节点不会作为子节点）
+        int symbol{-1};       //叶子节点对应的符号
+    };
+    std::vector<Node> nodes_;
+};
+
+//编码 HPACK 整数（RFC 7541 5.1），first_byte 为前缀之外的标志位
+inline auto encode_integer(std::string& out, uint64_t value, int prefix_bits, uint8_t first_byte) -> void{
+    const uint64_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        out += static_cast<char>(first_byte | value);
+        return;
+    }
+    out += static_cast<char>(first_byte | max_prefix);
+    value -= max_prefix;
+    while (value >= 128) {
+        out += static_cast<char>(value % 128 + 128);
+        value /= 128;
+    }
+    out += static_cast<char>(value);
+}
+
+//编码字符串字面量（不使用 Huffman）
+inline auto encode_string(std::string& out, std::string_view str) -> void{
+    encode_integer(out, str.size(), 7, 0x00);
+    out.append(str);
+}
+
+}
+
+//HPACK 解码器，每个连接一个（动态表是连接状态）
+class HpackDecoder {
+public:
+    explicit HpackDecoder(size_t max_table_size = 4096)
+        : max_table_size_(max_table_size), table_size_limit_(max_table_size){}
+
+    //解码一个完整的头部块，出错时返回 false（连接错误 COMPRESSION_ERROR）
+    auto decode(std::string_view block, HeaderBlock& out) -> bool{
+        size_t pos = 0;
+        while (pos < block.size()) {
+            auto byte = static_cast<uint8_t>(block[pos]);
+            if (byte & 0x80) {
+                //索引头部字段
+                uint64_t index;
+                if (!decode_integer(block, pos, 7, index) || index == 0) return false;
+                auto field = lookup(index);
+                if (!field) return false;
+                out.push_back(*field);
+            } else if (byte & 0x40) {
+                //带增量索引的字面量
+                HeaderField field;
+                if (!decode_literal(block, pos, 6, field)) return false;
+                add(field);
+                out.push_back(std::move(field));
+            } else if (byte & 0x20) {
+                //动态表大小更新
+                uint64_t size;
+                if (!decode_integer(block, pos, 5, size) || size > table_size_limit_) return false;
+                max_table_size_ = size;
+                evict(0);
+            } else {
+                //不索引（0000）或永不索引（0001）的字面量
+                HeaderField field;
+                if (!decode_literal(block, pos, 4, field)) return false;
+                out.push_back(std::move(field));
+            }
+        }
+        return true;
+    }
+
+private:
+    static auto decode_integer(std::string_view in, size_t& pos, int prefix_bits, uint64_t& value) -> bool{
+        if (pos >= in.size()) return false;
+        const uint64_t max_prefix = (1u << prefix_bits) - 1;
+        value = static_cast<uint8_t>(in[pos++]) & max_prefix;
+        if (value < max_prefix) return true;
+        int shift = 0;
+        while (pos < in.size()) {
+            auto byte = static_cast<uint8_t>(in[pos++]);
+            value += static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+            shift += 7;
+            if (shift > 56) return false;   //防止溢出
+        }
+        return false;
+    }
+
+    static auto decode_string(std::string_view in, size_t& pos, std::string& out) -> bool{
+        if (pos >= in.size()) return false;
+        bool huffman = static_cast<uint8_t>(in[pos]) & 0x80;
+        uint64_t length;
+        if (!decode_integer(in, pos, 7, length) || length > in.size() - pos) return false;
+        auto data = in.substr(pos, length);
+        pos += length;
+        if (huffman) return detail::HuffmanTree::instance().decode(data, out);
+        out.assign(data);
+        return true;
+    }
+
+    auto decode_literal(std::string_view in, size_t& pos, int prefix_bits, HeaderField& field) -> bool{
+        uint64_t index;
+        if (!decode_integer(in, pos, prefix_bits, index)) return false;
+        if (index == 0) {
+            if (!decode_string(in, pos, field.name)) return false;
+        } else {
+            auto name_field = lookup(index);
+            if (!name_field) return false;
+            field.name = name_field->name;
+        }
+        return decode_string(in, pos, field.value);
+    }
+
+    auto lookup(uint64_t index) const -> const HeaderField*{
+        static const std::array<HeaderField, 61> static_fields = [] {
+            std::array<HeaderField, 61> fields;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                fields[i] = {std::string(detail::kStaticTable[i].first),
+                             std::string(detail::kStaticTable[i].second)};
+            }
+            return fields;
+        }();
+        if (index >= 1 && index <= static_fields.size()) return &static_fields[index - 1];
+        index -= static_fields.size() + 1;
+        if (index < dynamic_table_.size()) return &dynamic_table_[index];
+        return nullptr;
+    }
+
+    static auto entry_size(const HeaderField& field) -> size_t{
+        return field.name.size() + field.value.size() + 32;
+    }
+
+    auto add(const HeaderField& field) -> void{
+        size_t size = entry_size(field);
+        evict(size);
+        //条目比整个表还大时清空表且不插入（RFC 7541 4.4）
+        if (size <= max_table_size_) {
+            dynamic_table_.push_front(field);
+            table_size_ += size;
+        }
+    }
+
+    //淘汰最旧的条目，直到能放下 extra 字节
+    auto evict(size_t extra) -> void{
+        while (!dynamic_table_.empty() && table_size_ + extra > max_table_size_) {
+            table_size_ -= entry_size(dynamic_table_.back());
+            dynamic_table_.pop_back();
+        }
+    }
+
+    std::deque<HeaderField> dynamic_table_;   //最新的条目在表头
+    size_t table_size_{0};
+    size_t max_table_size_;      //当前动态表大小上限
+    size_t table_size_limit_;    //通过 SETTINGS_HEADER_TABLE_SIZE 告知对端的上限
+};
+
+//HPACK 编码器：只使用静态表和不索引的字面量，不维护动态表，
+//因此不受对端 SETTINGS_HEADER_TABLE_SIZE 影响，也无需同步状态
+class HpackEncoder {
+public:
+    auto encode(const HeaderBlock& headers, std::string& out) const -> void{
+        for (const auto& [name, value] : headers) {
+            size_t name_index = 0;
+            size_t full_index = 0;
+            for (size_t i = 0; i < std::size(detail::kStaticTable); ++i) {
+                if (detail::kStaticTable[i].first != name) continue;
+                if (name_index == 0) name_index = i + 1;
+                if (detail::kStaticTable[i].second == value) {
+                    full_index = i + 1;
+                    break;
+                }
+            }
+
+            if (full_index != 0) {
+                detail::encode_integer(out, full_index, 7, 0x80);
+                continue;
+            }
+            //敏感字段使用"永不索引"，中间节点也不得缓存
+            uint8_t flags = (name == "authorization" || name == "set-cookie" || name == "cookie") ? 0x10 : 0x00;
+            detail::encode_integer(out, name_index, 4, flags);
+            if (name_index == 0) detail::encode_string(out, name);
+            detail::encode_string(out, value);
+        }
+    }
+};
+
+}
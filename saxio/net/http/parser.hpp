@@ -0,0 +1,122 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <optional>
+
+namespace saxio::http{
+
+//请求头部分（请求行 + 请求头）的最大长度
+inline constexpr size_t kMaxHeaderSize = 16 * 1024;
+
+//解析头部字段行（"Name: value"），键转为小写后存入 headers；
+//fields 非空时同时按原始顺序逐行保存，不合并重复的字段
+inline auto parse_header_lines(std::string_view view, size_t line_end,
+                               std::unordered_map<std::string, std::string>& headers,
+                               HeaderList* fields = nullptr) -> void{
+    //逐行解析请求头，直到空行
+    while (line_end != std::string_view::npos) {
+        size_t next = line_end + 2;
+        line_end = view.find("\r\n", next);
+        std::string_view line = view.substr(next, line_end == std::string_view::npos
+            ? std::string_view::npos : line_end - next);
+        if (line.empty()) break;
+
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        std::string name{line.substr(0, colon)};
+        std::ranges::transform(name, name.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        if (fields) fields->emplace_back(name, value);
+        //重复的头部按 RFC 7230 用逗号合并（Set-Cookie 不能合并，需要逐行使用 fields）
+        if (auto it = headers.find(name); it != headers.end()) {
+            it->second.append(", ").append(value);
+        } else {
+            headers.emplace(std::move(name), std::string(value));
+        }
+    }
+}
+
+//解析HTTP请求：请求行（方法、路径、版本）和请求头
+//请求行不完整时 method 为空，path 默认为 "/"
+inline auto parse_http_request(std::string_view view) -> HttpRequest{
+    HttpRequest request;
+    request.path = "/";
+
+    size_t line_end = view.find("\r\n");
+    std::string_view request_line = view.substr(0, line_end);
+
+    //简单的请求行解析：提取第一个空格和第二个空格之间的路径
+    size_t start = request_line.find(' ');
+    if (start == std::string_view::npos) return request;
+    size_t end = request_line.find(' ', start+1);
+    if (end == std::string_view::npos) return request;
+
+    request.method = request_line.substr(0, start);
+    request.path = request_line.substr(start+1, end-start-1);  //提取路径
+    request.version = request_line.substr(end+1);
+
+    parse_header_lines(view, line_end, request.headers);
+    return request;
+}
+
+//解析HTTP响应头：状态行（版本、状态码、描述）和响应头
+//状态行不合法时 status 为0
+inline auto parse_http_response(std::string_view view) -> HttpResponse{
+    HttpResponse response;
+
+    size_t line_end = view.find("\r\n");
+    std::string_view status_line = view.substr(0, line_end);
+
+    size_t start = status_line.find(' ');
+    if (start == std::string_view::npos || !status_line.starts_with("HTTP/")) return response;
+    std::string_view code = status_line.substr(start + 1, 3);
+    auto [ptr, ec] = std::from_chars(code.data(), code.data() + code.size(), response.status);
+    if (ec != std::errc{} || ptr != code.data() + code.size()) {
+        response.status = 0;
+        return response;
+    }
+    response.version = status_line.substr(0, start);
+    if (start + 5 < status_line.size()) {
+        response.reason = status_line.substr(start + 5);
+    }
+
+    parse_header_lines(view, line_end, response.headers, &response.fields);
+    return response;
+}
+
+//解析十进制长度值（Content-Length），格式非法时返回 std::nullopt
+inline auto parse_content_length(std::string_view value) -> std::optional<size_t>{
+    size_t length = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+    if (ec != std::errc{} || ptr != value.data() + value.size() || value.empty()) {
+        return std::nullopt;
+    }
+    return length;
+}
+
+//判断逗号分隔的头部值中是否包含指定标记（不区分大小写），如 Connection: keep-alive, Upgrade
+inline auto header_has_token(std::string_view value, std::string_view token) -> bool{
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string_view::npos) end = value.size();
+        std::string_view item = value.substr(start, end - start);
+        while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+        if (std::ranges::equal(item, token, [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            })) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include "saxio/net/http/parser.hpp"
+#include "saxio/net/http/body_reader.hpp"
+#include "saxio/net/http/response_utils.hpp"
+#include "saxio/net/http/client.hpp"
+#include "saxio/net.hpp"
+#include "saxio/common/debug.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace saxio::http{
+
+//负载均衡策略
+enum class BalanceStrategy {
+    ROUND_ROBIN,          //轮询
+    LEAST_CONNECTIONS,    //选择当前转发中请求最少的上游
+    CONSISTENT_HASH,      //一致性哈希：相同的键总是落到同一个上游，上游增减时只影响少量键
+};
+
+//反向代理：把请求转发到一组上游服务器。
+//上游连接由 Client 按主机池化复用；请求体和响应体边读边转发，不在内存中缓存完整内容。
+//被动健康检查：fail_timeout 时间窗口内连续失败 max_fails 次的上游在 fail_timeout 内不再被选中
+class ReverseProxy {
+public:
+    static constexpr size_t kVirtualNodes = 160;   //一致性哈希中每个上游的虚拟节点数
+
+    /**
+     * @param upstreams 上游地址，如 "http://127.0.0.1:8101"
+     * @param strategy  负载均衡策略
+     */
+    explicit ReverseProxy(const std::vector<std::string>& upstreams,
+                          BalanceStrategy strategy = BalanceStrategy::ROUND_ROBIN)
+        : strategy_(strategy){
+        for (const auto& url : upstreams) {
+            auto parsed = parse_url(url);
+            if (!parsed) {
+                LOG_ERROR("Invalid upstream url: {}", url);
+                continue;
+            }
+            auto upstream = std::make_unique<Upstream>();
+            upstream->base_url = std::format("http://{}", parsed->authority());
+            upstreams_.push_back(std::move(upstream));
+        }
+
+        //一致性哈希环：每个上游映射为多个虚拟节点，使键分布更均匀
+        for (size_t i = 0; i < upstreams_.size(); ++i) {
+            for (size_t v = 0; v < kVirtualNodes; ++v) {
+                ring_.emplace_back(hash(std::format("{}#{}", upstreams_[i]->base_url, v)), i);
+            }
+        }
+        std::ranges::sort(ring_);
+        client_.set_max_idle_per_host(64);
+        client_.set_max_response_size(std::numeric_limits<size_t>::max());   //响应体是流式转发的
+    }
+
+    //被动健康检查参数：时间窗口内失败 max_fails 次后，上游在 fail_timeout 内被视为不可用
+    auto set_max_fails(uint32_t max_fails) -> void{ max_fails_ = max_fails; }
+    auto set_fail_timeout(std::chrono::milliseconds timeout) -> void{ fail_timeout_ = timeout; }
+
+    //一致性哈希使用的请求头（如 "x-user-id"），未设置或请求中没有该头时使用请求路径
+    auto set_hash_header(std::string name) -> void{ hash_header_ = std::move(name); }
+
+    //连接上游失败时最多尝试的上游数
+    auto set_max_attempts(size_t attempts) -> void{ max_attempts_ = std::max<size_t>(attempts, 1); }
+
+    //转发使用的客户端，可调整超时和连接池大小
+    auto client() -> Client&{ return client_; }
+
+    //当前可用的上游数
+    [[nodiscard]]
+    auto healthy_upstreams() const -> size_t{
+        auto now = std::chrono::steady_clock::now();
+        return std::ranges::count_if(upstreams_, [&](const auto& u) { return u->available(now); });
+    }
+
+    //转发请求并把上游的响应返回给客户端
+    auto handle(net::TcpStream& stream, const HttpRequest& request, BodyReader& body) -> void{
+        std::vector<bool> tried(upstreams_.size(), false);
+        size_t attempts = std::min(max_attempts_, upstreams_.size());
+        Error last_error = make_error(Error::kClientConnectFailed);
+
+        for (size_t attempt = 0; attempt < attempts; ++attempt) {
+            Upstream* upstream = select(request, tried);
+            if (upstream == nullptr) break;
+
+            ClientRequest upstream_request{request.method, upstream->base_url + request.path,
+                                           forward_headers(stream, request), {}, {}};
+            if (body.framing() != BodyReader::Framing::NONE) {
+                upstream_request.body_source = [&body](std::span<char> buf) { return body.read(buf); };
+            }
+
+            ActiveGuard guard{*upstream};
+            auto response = client_.open(upstream_request);
+            if (!response) {
+                last_error = response.error();
+                upstream->record_failure(max_fails_, fail_timeout_);
+                LOG_WARN("Upstream {} failed: {}", upstream->base_url, last_error);
+                //请求体已经开始转发，或者请求可能已被上游处理（非幂等）时不能重试
+                bool connect_failed = last_error.value() == Error::kClientConnectFailed
+                                   || last_error.value() == Error::kResolveFailed;
+                if (body.bytes_read() > 0 || (!connect_failed && !detail::is_idempotent(request.method))) {
+                    break;
+                }
+                continue;
+            }
+            upstream->record_success();
+            relay_response(stream, response.value());
+            return;
+        }
+
+        if (last_error.value() == Error::kTimeout) {
+            ResponseUtils::send_simple_response(stream, HttpStatus::GATEWAY_TIMEOUT, "Upstream timed out\n");
+        } else if (std::ranges::none_of(tried, [](bool t) { return t; })) {
+            ResponseUtils::send_simple_response(stream, HttpStatus::SERVICE_UNAVAILABLE, "No healthy upstream\n");
+        } else {
+            ResponseUtils::send_simple_response(stream, HttpStatus::BAD_GATEWAY, "Bad gateway\n");
+        }
+    }
+
+private:
+    struct Upstream {
+        std::string base_url;
+        std::atomic<uint32_t> active{0};   //正在转发的请求数（最少连接策略）
+
+        std::mutex mutex;                  //保护下面的健康状态
+        uint32_t fails{0};
+        std::chrono::steady_clock::time_point window_start;
+        std::atomic<int64_t> down_until{0};    //不可用的截止时间（steady_clock 纳秒）
+
+        [[nodiscard]]
+        auto available(std::chrono::steady_clock::time_point now) const -> bool{
+            return now.time_since_epoch().count() >= down_until.load(std::memory_order_relaxed);
+        }
+
+        auto record_failure(uint32_t max_fails, std::chrono::milliseconds fail_timeout) -> void{
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = std::chrono::steady_clock::now();
+            if (fails == 0 || now - window_start > fail_timeout) {
+                window_start = now;
+                fails = 0;
+            }
+            if (++fails >= max_fails) {
+                down_until = (now + fail_timeout).time_since_epoch().count();
+                fails = 0;
+                LOG_WARN("Upstream {} marked down for {}ms", base_url, fail_timeout.count());
+            }
+        }
+
+        auto record_success() -> void{
+            std::lock_guard<std::mutex> lock(mutex);
+            fails = 0;
+        }
+    };
+
+    //转发期间计入上游的活动请求数
+    struct ActiveGuard {
+        explicit ActiveGuard(Upstream& u) : upstream(u){ upstream.active.fetch_add(1, std::memory_order_relaxed); }
+        ~ActiveGuard(){ upstream.active.fetch_sub(1, std::memory_order_relaxed); }
+        Upstream& upstream;
+    };
+
+    //FNV-1a 64位哈希，再经过 splitmix64 混合使哈希环上的分布更均匀
+    static auto hash(std::string_view key) -> uint64_t{
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    //按负载均衡策略选择一个可用且本次请求尚未尝试过的上游
+    auto select(const HttpRequest& request, std::vector<bool>& tried) -> Upstream*{
+        size_t n = upstreams_.size();
+        if (n == 0) return nullptr;
+        auto now = std::chrono::steady_clock::now();
+        auto usable = [&](size_t i) { return !tried[i] && upstreams_[i]->available(now); };
+
+        std::optional<size_t> chosen;
+        if (strategy_ == BalanceStrategy::CONSISTENT_HASH) {
+            std::string_view key = request.path;
+            if (!hash_header_.empty() && !request.header(hash_header_).empty()) key = request.header(hash_header_);
+            //沿哈希环顺时针找到第一个可用的上游
+            auto it = std::ranges::lower_bound(ring_, std::pair{hash(key), size_t{0}});
+            for (size_t k = 0; k < ring_.size() && !chosen; ++k, ++it) {
+                if (it == ring_.end()) it = ring_.begin();
+                if (usable(it->second)) chosen = it->second;
+            }
+        } else {
+            size_t start = next_.fetch_add(1, std::memory_order_relaxed) % n;
+            for (size_t k = 0; k < n; ++k) {
+                size_t i = (start + k) % n;
+                if (!usable(i)) continue;
+                if (strategy_ == BalanceStrategy::ROUND_ROBIN) {
+                    chosen = i;
+                    break;
+                }
+                //最少连接：从轮询起点开始比较，活动数相同时各上游轮流被选中
+                if (!chosen || upstreams_[i]->active.load(std::memory_order_relaxed)
+                               < upstreams_[*chosen]->active.load(std::memory_order_relaxed)) {
+                    chosen = i;
+                }
+            }
+        }
+        if (!chosen) return nullptr;
+        tried[*chosen] = true;
+        return upstreams_[*chosen].get();
+    }
+
+    //逐跳头部只对单个连接有效，不能转发（RFC 7230 6.1）
+    static auto is_hop_by_hop(std::string_view name, std::string_view connection) -> bool{
+        return name == "connection" || name == "keep-alive" || name == "proxy-connection"
+            || name == "te" || name == "trailer" || name == "transfer-encoding" || name == "upgrade"
+            || header_has_token(connection, name);
+    }
+
+    //构造转发给上游的请求头，追加 X-Forwarded-* 头
+    static auto forward_headers(net::TcpStream& stream, const HttpRequest& request) -> HeaderList{
+        HeaderList headers;
+        auto connection = request.header("connection");
+        for (const auto& [name, value] : request.headers) {
+            //100-continue 由本端的 BodyReader 处理，上游不需要再等待
+            if (is_hop_by_hop(name, connection) || name == "expect" || name == "x-forwarded-for") continue;
+            headers.emplace_back(name, value);
+        }
+
+        std::string forwarded_for{request.header("x-forwarded-for")};
+        if (auto peer = peer_address(stream.fd()); !peer.empty()) {
+            forwarded_for = forwarded_for.empty() ? peer : forwarded_for + ", " + peer;
+        }
+        if (!forwarded_for.empty()) headers.emplace_back("x-forwarded-for", std::move(forwarded_for));
+        if (auto host = request.header("host"); !host.empty()) headers.emplace_back("x-forwarded-host", host);
+        headers.emplace_back("x-forwarded-proto", "http");
+        return headers;
+    }
+
+    //获取对端 IP 地址（HTTP/2 的流桥接等非 TCP 连接返回空串）
+    static auto peer_address(int fd) -> std::string{
+        sockaddr_storage addr{};
+        socklen_t len = sizeof(addr);
+        if (::getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) return {};
+        char buf[INET6_ADDRSTRLEN] = {};
+        if (addr.ss_family == AF_INET) {
+            inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(&addr)->sin_addr, buf, sizeof(buf));
+        } else if (addr.ss_family == AF_INET6) {
+            inet_ntop(AF_INET6, &reinterpret_cast<sockaddr_in6*>(&addr)->sin6_addr, buf, sizeof(buf));
+        }
+        return buf;
+    }
+
+    //转发上游响应：响应头去掉逐跳头部后逐行原样转发（多个 Set-Cookie 不能合并），响应体边读边写
+    //没有 Content-Length 的响应体（chunked 或读到关闭为止）以关闭连接结束
+    static auto relay_response(net::TcpStream& stream, ResponseStream& response) -> void{
+        const HttpResponse& head = response.head();
+        std::string out = std::format("HTTP/1.1 {} {}\r\n", head.status, head.reason);
+        auto connection = head.header("connection");
+        for (const auto& [name, value] : head.fields) {
+            if (is_hop_by_hop(name, connection)) continue;
+            out.append(name).append(": ").append(value).append("\r\n");
+        }
+        out += "Connection: close\r\n\r\n";
+        if (auto ret = write_all(stream.fd(), out); !ret) {
+            LOG_ERROR("Send proxied response header failed: {}", ret.error());
+            return;
+        }
+
+        thread_local std::vector<char> buf(64 * 1024);
+        while (true) {
+            auto n = response.read({buf.data(), buf.size()});
+            if (!n) {
+                LOG_ERROR("Read upstream response failed: {}", n.error());
+                return;
+            }
+            if (n.value() == 0) return;
+            if (auto ret = write_all(stream.fd(), {buf.data(), n.value()}); !ret) {
+                LOG_ERROR("Send proxied response body failed: {}", ret.error());
+                return;
+            }
+        }
+    }
+
+    BalanceStrategy strategy_;
+    std::vector<std::unique_ptr<Upstream>> upstreams_;
+    std::vector<std::pair<uint64_t, size_t>> ring_;   //一致性哈希环：哈希值 -> 上游下标
+    std::atomic<size_t> next_{0};                     //轮询计数
+    Client client_;
+    uint32_t max_fails_{1};
+    std::chrono::milliseconds fail_timeout_{std::chrono::seconds(10)};
+    std::string hash_header_;
+    size_t max_attempts_{2};
+};
+
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <format>
+
+namespace saxio::http{
+
+//按键（如客户端 IP）限速的令牌桶，每秒补充 rate 个令牌，桶容量为 burst
+//
+//每个桶只保存一个时间戳（GCRA，与令牌桶等价）：下一个请求的理论到达时间 tat。
+//tat 比当前时间超前不超过 burst 个令牌的时间时放行，并把 tat 推后一个令牌的时间。
+//桶按键的哈希分布到多个分片，每个分片一把锁，不同客户端之间几乎没有竞争；
+//空闲（桶已补满）超过 idle_timeout 的键在访问所在分片时顺带清理。
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RateLimiter(double rate, double burst, size_t shards = 64,
+                std::chrono::milliseconds idle_timeout = std::chrono::seconds(60))
+        : shards_(std::bit_ceil(std::max<size_t>(shards, 1))), idle_timeout_ns_(idle_timeout.count() * 1'000'000LL){
+        set_rate(rate, burst);
+    }
+
+    //修改速率和容量（已有的桶按新的参数继续计算），应在开始使用前设置
+    auto set_rate(double rate, double burst) -> void{
+        rate = std::max(rate, 1e-9);
+        burst = std::max(burst, 1.0);
+        interval_ns_ = static_cast<int64_t>(1e9 / rate);
+        tolerance_ns_ = static_cast<int64_t>((burst - 1.0) * 1e9 / rate);
+    }
+
+    //尝试消耗一个令牌，返回 false 表示超出速率
+    auto allow(uint64_t key) -> bool{
+        return allow(key, now_ns());
+    }
+
+    auto allow(uint64_t key, int64_t now) -> bool{
+        Shard& shard = shards_[mix(key) & (shards_.size() - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (now - shard.last_sweep >= idle_timeout_ns_) {
+            sweep(shard, now);
+        }
+
+        auto [it, inserted] = shard.buckets.try_emplace(key, now);
+        int64_t tat = std::max(it->second, now);
+        if (tat - now > tolerance_ns_) {
+            return false;
+        }
+        it->second = tat + interval_ns_;
+        return true;
+    }
+
+    //拒绝后客户端至少需要等待的时间（用于 Retry-After）
+    [[nodiscard]]
+    auto retry_after() const -> std::chrono::seconds{
+        return std::chrono::seconds(std::max<int64_t>(1, (interval_ns_ + 999'999'999) / 1'000'000'000));
+    }
+
+    //当前跟踪的键数量
+    [[nodiscard]]
+    auto size() -> size_t{
+        size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.buckets.size();
+        }
+        return total;
+    }
+
+    static auto now_ns() -> int64_t{
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+private:
+    //分片独占缓存行，避免不同分片的锁伪共享
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, int64_t> buckets;   //键 -> 理论到达时间（纳秒）
+        int64_t last_sweep{0};
+    };
+
+    //清理桶已补满且空闲超过 idle_timeout 的键；调用方需持有分片的锁
+    auto sweep(Shard& shard, int64_t now) const -> void{
+        std::erase_if(shard.buckets, [&](const auto& entry) {
+            return now - entry.second >= idle_timeout_ns_;
+        });
+        shard.last_sweep = now;
+    }
+
+    //打散键的低位（IPv4 地址的低位分布不均匀）
+    static auto mix(uint64_t key) -> uint64_t{
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    std::vector<Shard> shards_;
+    int64_t idle_timeout_ns_;
+    int64_t interval_ns_{0};      //每个令牌的补充时间
+    int64_t tolerance_ns_{0};     //允许 tat 超前当前时间的最大值，(burst - 1) 个令牌的时间
+};
+
+//服务器的客户端限速配置：按客户端 IP 限制连接速率和请求速率，并可按路由前缀单独限速
+//未配置的限速不产生任何开销；配置应在服务器启动前完成
+class ClientRateLimits {
+public:
+    ClientRateLimits(){
+        rebuild_response();
+    }
+
+    //每个 IP 每秒新建连接数，在 accept 时检查
+    auto set_connection_rate(double rate, double burst) -> void{
+        connection_limiter_ = std::make_unique<RateLimiter>(rate, burst);
+        rebuild_response();
+    }
+
+    //每个 IP 每秒请求数（所有路由合计）
+    auto set_request_rate(double rate, double burst) -> void{
+        request_limiter_ = std::make_unique<RateLimiter>(rate, burst);
+        rebuild_response();
+    }
+
+    //每个 IP 在指定路由前缀下的每秒请求数（最长前缀匹配），与总请求速率同时生效
+    auto set_route_rate(std::string path_prefix, double rate, double burst) -> void{
+        for (auto& [prefix, limiter] : route_limiters_) {
+            if (prefix == path_prefix) {
+                limiter = std::make_unique<RateLimiter>(rate, burst);
+                rebuild_response();
+                return;
+            }
+        }
+        route_limiters_.emplace_back(std::move(path_prefix), std::make_unique<RateLimiter>(rate, burst));
+        rebuild_response();
+    }
+
+    //新连接是否放行
+    auto allow_connection(uint32_t ip) -> bool{
+        return !connection_limiter_ || connection_limiter_->allow(ip);
+    }
+
+    //请求是否放行
+    auto allow_request(uint32_t ip, const std::string& path) -> bool{
+        if (request_limiter_ && !request_limiter_->allow(ip)) {
+            return false;
+        }
+        if (route_limiters_.empty()) {
+            return true;
+        }
+
+        RateLimiter* best = nullptr;
+        size_t best_len = 0;
+        for (const auto& [prefix, limiter] : route_limiters_) {
+            if (path.starts_with(prefix) && prefix.size() >= best_len) {
+                best = limiter.get();
+                best_len = prefix.size();
+            }
+        }
+        return best == nullptr || best->allow(ip);
+    }
+
+    //预先生成的 429 响应
+    [[nodiscard]]
+    auto too_many_requests_response() const -> std::string_view{ return response_; }
+
+private:
+    //Retry-After 取所有限速中最长的令牌补充时间
+    auto rebuild_response() -> void{
+        std::chrono::seconds retry_after{1};
+        if (connection_limiter_) retry_after = std::max(retry_after, connection_limiter_->retry_after());
+        if (request_limiter_) retry_after = std::max(retry_after, request_limiter_->retry_after());
+        for (const auto& [prefix, limiter] : route_limiters_) {
+            retry_after = std::max(retry_after, limiter->retry_after());
+        }
+
+        static constexpr std::string_view body = "Too many requests\n";
+        response_ = std::format(
+            "HTTP/1.1 429 {}\r\nContent-Type: text/plain; charset=utf-8\r\nContent-Length: {}\r\n"
+            "Retry-After: {}\r\nConnection: close\r\n\r\n{}",
+            get_status_text(HttpStatus::TOO_MANY_REQUESTS), body.size(), retry_after.count(), body);
+    }
+
+    std::unique_ptr<RateLimiter> connection_limiter_;    //连接速率
+    std::unique_ptr<RateLimiter> request_limiter_;       //请求速率
+    std::vector<std::pair<std::string, std::unique_ptr<RateLimiter>>> route_limiters_;  //路由前缀 -> 请求速率
+    std::string response_;     //预先生成的 429 响应
+};
+
+}
@@ -1,8 +1,20 @@
 #pragma once
 #include "saxio/net/http/types.hpp"
 #include "saxio/net/http/response_utils.hpp"
+#include "saxio/net/http/file_meta_cache.hpp"
+#include "saxio/net/http/compression.hpp"
+#include "saxio/net/http/body_reader.hpp"
+#include "saxio/net/http/websocket.hpp"
+#include "saxio/net/http/static_files.hpp"
+#include "saxio/net/http/response_cache.hpp"
+#include "saxio/net/http/embedded_assets.hpp"
 #include "saxio/net.hpp"
 #include "saxio/common/debug.hpp"
+#include <cstdlib>
+#include <functional>
+#include <fstream>
+#include <span>
+#include <sys/mman.h>
 
 namespace saxio::http{
 
@@ -10,29 +22,264 @@ namespace saxio::http{
 class RequestHandler {
 public:
     //处理HTTP请求的主入口函数
-    static auto handle_request(net::TcpStream& stream, const std::string& request) -> void {
-        std::string path = parse_http_request(request);
+    auto handle_request(net::TcpStream& stream, const HttpRequest& request, BodyReader& body) -> void {
+        const std::string& path = request.path;
         LOG_INFO("HTTP Request for path: {}", path);
 
+        //WebSocket 升级：握手成功后连接交给对应的处理函数，直到其返回
+        if (WebSocket::is_upgrade_request(request)) {
+            if (auto it = websocket_handlers_.find(path); it != websocket_handlers_.end()) {
+                handle_websocket(stream, request, body, it->second);
+                return;
+            }
+        }
+
+        //开启了响应缓存的路径：命中时直接发送缓存的响应，不再执行处理函数
+        if (const ResponseCacheRule* rule = find_response_cache_rule(request, body)) {
+            serve_cached(stream, request, body, *rule);
+            return;
+        }
+
+        route_request(stream, request, body);
+    }
+
+    //路由处理函数（如反向代理），负责发送完整的响应
+    using RouteHandler = std::function<void(net::TcpStream&, const HttpRequest&, BodyReader&)>;
+
+    //为指定路径前缀注册处理函数（最长前缀匹配）
+    auto add_route(std::string path_prefix, RouteHandler handler) -> void{
+        for (auto& [prefix, old_handler] : routes_) {
+            if (prefix == path_prefix) {
+                old_handler = std::move(handler);
+                return;
+            }
+        }
+        routes_.emplace_back(std::move(path_prefix), std::move(handler));
+    }
+
+    //为指定路径前缀开启响应缓存（最长前缀匹配，只缓存 GET/HEAD 的 200 响应）
+    //缓存键由方法、路径（含查询串）、Accept-Encoding 以及 vary_headers 中的请求头组成
+    auto enable_response_cache(std::string path_prefix, std::chrono::milliseconds ttl,
+                               std::vector<std::string> vary_headers = {}) -> void{
+        for (auto& name : vary_headers) {
+            std::ranges::transform(name, name.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        }
+        if (!response_cache_) {
+            response_cache_ = std::make_unique<ResponseCache>(response_cache_bytes_);
+        }
+        for (auto& rule : response_cache_rules_) {
+            if (rule.path_prefix == path_prefix) {
+                rule.ttl = ttl;
+                rule.vary_headers = std::move(vary_headers);
+                return;
+            }
+        }
+        response_cache_rules_.push_back({std::move(path_prefix), ttl, std::move(vary_headers)});
+    }
+
+    //设置响应缓存的内存上限（在 enable_response_cache 之前调用）
+    auto set_response_cache_size(size_t max_bytes) -> void{ response_cache_bytes_ = max_bytes; }
+
+    //获取响应缓存（如主动失效），未开启时返回 nullptr
+    auto response_cache() -> ResponseCache*{ return response_cache_.get(); }
+
+    //将 URL 前缀映射到磁盘上的文档根目录（最长前缀匹配），在注册路由和内置页面都不匹配时使用
+    //访问目录时依次尝试 index_files，不生成目录列表
+    auto mount_static(std::string url_prefix, std::string document_root,
+                      std::vector<std::string> index_files = {"index.html"}) -> void{
+        if (!url_prefix.starts_with('/')) url_prefix.insert(0, "/");
+        while (url_prefix.size() > 1 && url_prefix.ends_with('/')) url_prefix.pop_back();
+        while (document_root.size() > 1 && document_root.ends_with('/')) document_root.pop_back();
+
+        for (auto& mount : static_mounts_) {
+            if (mount.url_prefix == url_prefix) {
+                mount.document_root = std::move(document_root);
+                mount.index_files = std::move(index_files);
+                return;
+            }
+        }
+        static_mounts_.push_back({std::move(url_prefix), std::move(document_root), std::move(index_files)});
+    }
+
+    //将编译期嵌入的资源表挂载到 URL 前缀下（精确匹配，目录请求尝试 index.html），优先于磁盘上的静态文件
+    //资源表由 CMake 的 saxio_embed_assets() 生成，发送时不访问文件系统
+    auto mount_embedded(std::string_view url_prefix, std::span<const EmbeddedAsset> assets) -> void{
+        while (url_prefix.ends_with('/')) url_prefix.remove_suffix(1);
+        for (const auto& asset : assets) {
+            embedded_assets_[std::string(url_prefix).append(asset.path)] = &asset;
+        }
+    }
+
+    //WebSocket 处理函数，在连接线程中运行，返回后连接关闭
+    using WebSocketHandler = std::function<void(WebSocket&)>;
+
+    //为指定路径注册 WebSocket 处理函数（精确匹配）
+    auto set_websocket_handler(std::string path, WebSocketHandler handler) -> void{
+        websocket_handlers_[std::move(path)] = std::move(handler);
+    }
+
+    //为指定路径前缀配置 Cache-Control 响应头（最长前缀匹配），如 "/img" -> "public, max-age=3600"
+    auto set_cache_control(std::string path_prefix, std::string value) -> void{
+        for (auto& [prefix, old_value] : cache_control_rules_) {
+            if (prefix == path_prefix) {
+                old_value = std::move(value);
+                return;
+            }
+        }
+        cache_control_rules_.emplace_back(std::move(path_prefix), std::move(value));
+    }
+
+    //获取文件元数据缓存（可调整重新校验间隔）
+    auto file_meta_cache() -> FileMetaCache&{ return file_meta_cache_; }
+
+    //设置上传文件的保存目录
+    auto set_upload_dir(std::string dir) -> void{ upload_dir_ = std::move(dir); }
+
+    //设置允许即时压缩的最大文件大小，超过的文件只使用预压缩的 .gz 文件或原样发送
+    auto set_max_compress_file_size(size_t size) -> void{ max_compress_file_size_ = size; }
+
+private:
+    //按路由、内置页面、静态文件的顺序分发请求
+    auto route_request(net::TcpStream& stream, const HttpRequest& request, BodyReader& body) -> void{
+        const std::string& path = request.path;
+
+        //注册的路由优先于内置路由
+        if (const RouteHandler* route = find_route(path)) {
+            (*route)(stream, request, body);
+            return;
+        }
+
         //路由分发
         if (path == "/" || path == "/index.html") {
-            handle_root(stream);
-        }else if (path == "/img.png") {
-            handle_image(stream);
+            handle_root(stream, request);
+        }else if (path == "/upload") {
+            handle_upload(stream, request, body);
         }else if (path == "/favicon.ico"){
             //忽略favicon.ico请求，或者返回一个空的响应
             ResponseUtils::send_response_header(
                 stream, HttpStatus::OK, "image/x-icon",0);
         }
+        else if (const EmbeddedAsset* asset = find_embedded_asset(path)) {
+            serve_embedded(stream, request, *asset);
+        }
+        else if (const StaticMount* mount = find_static_mount(path)) {
+            serve_static(stream, request, *mount);
+        }
         else {
             handle_not_found(stream);
         }
     }
 
-private:
+    //通过响应缓存发送：未命中时把处理函数的输出写入内存文件，读回后缓存并发送给客户端
+    auto serve_cached(net::TcpStream& stream, const HttpRequest& request, BodyReader& body,
+                      const ResponseCacheRule& rule) -> void{
+        std::string key = make_response_cache_key(request, rule);
+        auto response = response_cache_->get_or_compute(key, rule.ttl,
+            [&]() -> ResponseCache::Computed {
+                return capture_response(stream, request, body, key.size());
+            });
+        if (!response) return;   //无法捕获或无法缓存时响应已直接发送给客户端
+
+        if (auto ret = write_all(stream.fd(), *response); !ret) {
+            LOG_ERROR("Send cached response failed: {}", ret.error());
+        }
+    }
+
+    //在内存文件上执行处理函数，得到完整的序列化响应
+    //超过单条缓存上限的响应（如大文件）不读回内存，直接从内存文件发送给客户端
+    auto capture_response(net::TcpStream& stream, const HttpRequest& request,
+                          BodyReader& body, size_t key_size) -> ResponseCache::Computed{
+        int memfd = ::memfd_create("saxio-response", MFD_CLOEXEC);
+        if (memfd < 0) {
+            LOG_ERROR("Create response capture failed: {}", strerror(errno));
+            route_request(stream, request, body);
+            return {};
+        }
+
+        net::TcpStream capture{net::detail::Socket{memfd}};
+        route_request(capture, request, body);
+
+        off_t size = ::lseek(capture.fd(), 0, SEEK_END);
+        if (size < 0) {
+            LOG_ERROR("Read captured response failed: {}", strerror(errno));
+            ResponseUtils::send_simple_response(stream, HttpStatus::INTERNAL_ERROR, "Internal Error");
+            return {};
+        }
+        if (key_size + static_cast<size_t>(size) > response_cache_->max_entry_bytes()) {
+            if (::lseek(capture.fd(), 0, SEEK_SET) < 0) {
+                LOG_ERROR("Rewind captured response failed: {}", strerror(errno));
+                ResponseUtils::send_simple_response(stream, HttpStatus::INTERNAL_ERROR, "Internal Error");
+                return {};
+            }
+            ResponseUtils::send_fd_content(stream, capture.fd(), static_cast<size_t>(size));
+            return {};
+        }
+
+        auto response = std::make_shared<std::string>(static_cast<size_t>(size), '\0');
+        if (::pread(capture.fd(), response->data(), response->size(), 0)
+            != static_cast<ssize_t>(response->size())) {
+            LOG_ERROR("Read captured response failed: {}", strerror(errno));
+            ResponseUtils::send_simple_response(stream, HttpStatus::INTERNAL_ERROR, "Internal Error");
+            return {};
+        }
+        bool cacheable = ResponseCache::is_cacheable_response(*response);
+        return {std::move(response), cacheable};
+    }
+
+    //查找适用的响应缓存规则：只缓存没有请求体、没有条件头和认证信息的 GET/HEAD 请求
+    auto find_response_cache_rule(const HttpRequest& request, const BodyReader& body) const
+        -> const ResponseCacheRule*{
+        if (response_cache_rules_.empty()
+            || (request.method != "GET" && request.method != "HEAD")
+            || body.framing() != BodyReader::Framing::NONE
+            || !request.header("if-none-match").empty()
+            || !request.header("if-modified-since").empty()
+            || !request.header("authorization").empty()) {
+            return nullptr;
+        }
+
+        const ResponseCacheRule* best = nullptr;
+        size_t best_len = 0;
+        for (const auto& rule : response_cache_rules_) {
+            if (request.path.starts_with(rule.path_prefix) && rule.path_prefix.size() >= best_len) {
+                best = &rule;
+                best_len = rule.path_prefix.size();
+            }
+        }
+        return best;
+    }
+
+    //缓存键："方法 路径" 之后逐行追加 "请求头: 值"
+    static auto make_response_cache_key(const HttpRequest& request, const ResponseCacheRule& rule) -> std::string{
+        std::string key = request.method;
+        key.append(" ").append(request.path);
+        key.append("\naccept-encoding: ").append(request.header("accept-encoding"));
+        for (const auto& name : rule.vary_headers) {
+            key.append("\n").append(name).append(": ").append(request.header(name));
+        }
+        return key;
+    }
+
+    //完成 WebSocket 握手并运行处理函数；处理函数没有发起关闭时以 1000 关闭连接
+    static auto handle_websocket(net::TcpStream& stream, const HttpRequest& request,
+                                 BodyReader& body, const WebSocketHandler& handler) -> void{
+        if (!WebSocket::accept(stream, request)) {
+            return;
+        }
+        LOG_INFO("WebSocket connection established: {} {}", stream.fd(), request.path);
+
+        WebSocket ws{stream, body.take_buffered()};
+        handler(ws);
+        if (!ws.closed()) {
+            (void)ws.close(ws::CloseCode::NORMAL);
+        }
+        LOG_INFO("WebSocket connection finished: {}", stream.fd());
+    }
+
     //处理根路径请求，返回简历首页
-    static auto handle_root(net::TcpStream& stream) -> void{
-        const char* html = R"(
+    auto handle_root(net::TcpStream& stream, const HttpRequest& request) -> void{
+        static constexpr std::string_view html = R"(
 <!DOCTYPE html>
 <html>
 <head>
@@ -54,41 +301,203 @@ private:
 </body>
 </html>
 )";
+        //页面内容固定，ETag 只在第一次访问时计算
+        static const std::string etag = make_content_etag(html);
+        serve_content(stream, request, html, etag, get_mime_type(".html"));
+    }
+
+    //从挂载的文档根目录发送文件：路径先规范化，越过根目录的请求按404处理
+    auto serve_static(net::TcpStream& stream, const HttpRequest& request, const StaticMount& mount) -> void{
+        if (request.method != "GET" && request.method != "HEAD") {
+            ResponseUtils::send_simple_response(stream, HttpStatus::METHOD_NOT_ALLOWED,
+                "Method not allowed\n", {{"Allow", "GET, HEAD"}});
+            return;
+        }
+
+        auto normalized = normalize_request_path(request.path);
+        if (!normalized) {
+            LOG_WARN("Rejected static path: {}", request.path);
+            handle_not_found(stream);
+            return;
+        }
+        //规范化后必须仍位于挂载前缀之下（"/assets/../x" 不能落到其他挂载点的文件）
+        auto relative = strip_mount_prefix(*normalized, mount.url_prefix);
+        if (!relative) {
+            handle_not_found(stream);
+            return;
+        }
+
+        std::string file_path = mount.document_root + std::string(*relative);
+        if (!relative->ends_with('/') && file_meta_cache_.lookup(file_path)) {
+            serve_file(stream, request, file_path);
+            return;
+        }
+
+        struct stat st{};
+        if (::stat(file_path.c_str(), &st) < 0 || !S_ISDIR(st.st_mode)) {
+            handle_not_found(stream);
+            return;
+        }
+        //目录的相对链接依赖结尾的 '/'，先重定向补全
+        if (!normalized->ends_with('/')) {
+            std::string location = *normalized + "/";
+            if (auto query = request.path.find('?'); query != std::string::npos) {
+                location += request.path.substr(query);
+            }
+            ResponseUtils::send_simple_response(stream, HttpStatus::MOVED_PERMANENTLY,
+                "Moved permanently\n", {{"Location", location}});
+            return;
+        }
+        if (file_path.ends_with('/')) file_path.pop_back();
+        for (const auto& index : mount.index_files) {
+            if (file_meta_cache_.lookup(file_path + "/" + index)) {
+                serve_file(stream, request, file_path + "/" + index);
+                return;
+            }
+        }
+        handle_not_found(stream);
+    }
+
+    //处理上传请求：请求体直接写入上传目录下的临时文件，内存占用与上传大小无关
+    auto handle_upload(net::TcpStream& stream, const HttpRequest& request, BodyReader& body) -> void{
+        if (request.method != "POST" && request.method != "PUT") {
+            ResponseUtils::send_simple_response(stream, HttpStatus::METHOD_NOT_ALLOWED,
+                "Use POST or PUT to upload\n", {{"Allow", "POST, PUT"}});
+            return;
+        }
+
+        std::string file_path = upload_dir_ + "/saxio-upload-XXXXXX";
+        io::detail::FD file{::mkstemp(file_path.data())};
+        if (!file.is_valid()) {
+            LOG_ERROR("Create upload file failed in {}: {}", upload_dir_, strerror(errno));
+            ResponseUtils::send_simple_response(stream, HttpStatus::INTERNAL_ERROR, "Upload failed\n");
+            return;
+        }
+
+        auto ret = body.spill_to_fd(file.fd());
+        if (!ret) {
+            LOG_ERROR("Receive upload failed: {}", ret.error());
+            ::unlink(file_path.c_str());
+            if (ret.error().value() == Error::kHttpBodyTooLarge) {
+                ResponseUtils::send_simple_response(stream, HttpStatus::PAYLOAD_TOO_LARGE, "Body too large\n");
+            } else {
+                ResponseUtils::send_simple_response(stream, HttpStatus::BAD_REQUEST, "Bad request body\n");
+            }
+            return;
+        }
+
+        LOG_INFO("Saved upload: {} ({} bytes)", file_path, ret.value());
+        std::string name = file_path.substr(file_path.rfind('/') + 1);
+        ResponseUtils::send_simple_response(stream, HttpStatus::CREATED,
+            std::format("Received {} bytes as {}\n", ret.value(), name));
+    }
+
+    //发送内存中的固定内容：支持条件请求，可压缩类型按 ETag（内容哈希）缓存压缩结果
+    auto serve_content(net::TcpStream& stream, const HttpRequest& request,
+                       std::string_view body, const std::string& etag,
+                       const std::string& mime_type) -> void{
+        HeaderList headers;
+        std::string_view payload = body;
+        std::string variant_etag = etag;
+        std::shared_ptr<const std::string> compressed;
+
+        if (is_compressible(mime_type)) {
+            headers.emplace_back("Vary", "Accept-Encoding");
+            auto encoding = negotiate_encoding(request.header("accept-encoding"));
+            if (encoding != ContentEncoding::IDENTITY) {
+                compressed = compression_cache_.get_or_compress(etag, encoding,
+                    [body] { return std::optional<std::string>(body); });
+            }
+            if (compressed) {
+                payload = *compressed;
+                headers.emplace_back("Content-Encoding", get_encoding_name(encoding));
+                variant_etag = make_variant_etag(etag, get_encoding_name(encoding));
+            }
+        }
+
+        append_validators(headers, request.path, variant_etag, "");
+        if (is_not_modified(request, variant_etag, 0)) {
+            ResponseUtils::send_not_modified(stream, headers);
+            return;
+        }
+
         //发送HTTP响应头成功
         if (ResponseUtils::send_response_header(
-            stream, HttpStatus::OK, get_mime_type(".html"), strlen(html))) {
-            auto ret = stream.write(html);
+            stream, HttpStatus::OK, mime_type, payload.size(), headers) && request.method != "HEAD") {
+            //嵌入资源可能较大，循环写完
+            auto ret = write_all(stream.fd(), payload);
             if (!ret) {
                 LOG_ERROR("Send response header failed: {}" ,ret.error());
             }
         }
     }
 
-    //处理图片请求，返回图片
-    static auto handle_image(net::TcpStream& stream) -> void{
-        std::string image_path = "/home/dinghaifeng/CLionProjects/saxio/doc/img.png";
-
-        //检查文件是否存在
-        std::ifstream test_file(image_path);
-        if (!test_file) {
-            LOG_ERROR("Image file not found: {}", image_path);
+    //发送磁盘文件：支持条件请求；可压缩类型优先使用预压缩的 .gz 文件，
+    //否则按文件版本（ETag）压缩一次并缓存，之后的请求直接复用
+    auto serve_file(net::TcpStream& stream, const HttpRequest& request,
+                    const std::string& file_path) -> void{
+        //检查文件是否存在并获取缓存的元数据（大小、ETag、Last-Modified）
+        auto meta = file_meta_cache_.lookup(file_path);
+        if (!meta) {
+            LOG_ERROR("File not found: {}", file_path);
             //文件不存在直接进入404页面
             handle_not_found(stream);
             return;
         }
-        test_file.close();
 
-        //获取文件大小(ate:文件打开后文件指针会直接定位到文件的末尾，用于快速获取文件大小)
-        std::ifstream file(image_path, std::ios::binary | std::ios::ate);
-        size_t file_size = file.tellg();   //获取当前指针位置（即文件大小）
-        file.close();
+        std::string mime_type = get_mime_type(file_path);
+        HeaderList headers;
+        std::string send_path = file_path;
+        size_t content_length = meta->size;
+        std::string etag = meta->etag;
+        std::shared_ptr<const std::string> compressed;
 
-        LOG_INFO("Server image: {} (size: {} bytes)", image_path, file_size);
+        if (is_compressible(mime_type)) {
+            headers.emplace_back("Vary", "Accept-Encoding");
+            auto encoding = negotiate_encoding(request.header("accept-encoding"));
 
-        //发送图片响应
-        if (ResponseUtils::send_response_header(
-            stream, HttpStatus::OK, get_mime_type(image_path), file_size)) {
-            ResponseUtils::send_file_content(stream, image_path);
+            //预压缩文件必须不比原文件旧，否则视为过期
+            if (encoding == ContentEncoding::GZIP) {
+                if (auto gz_meta = file_meta_cache_.lookup(file_path + ".gz");
+                    gz_meta && gz_meta->mtime >= meta->mtime) {
+                    send_path = file_path + ".gz";
+                    content_length = gz_meta->size;
+                }
+            }
+            if (send_path == file_path && encoding != ContentEncoding::IDENTITY
+                && meta->size <= max_compress_file_size_) {
+                compressed = compression_cache_.get_or_compress(meta->etag, encoding,
+                    [&file_path] { return read_file(file_path); });
+                if (compressed) content_length = compressed->size();
+            }
+            if (send_path != file_path || compressed) {
+                headers.emplace_back("Content-Encoding", get_encoding_name(encoding));
+                etag = make_variant_etag(meta->etag, get_encoding_name(encoding));
+            }
+        }
+
+        append_validators(headers, request.path, etag, meta->last_modified);
+        if (is_not_modified(request, etag, meta->mtime)) {
+            LOG_INFO("File not modified: {}", file_path);
+            ResponseUtils::send_not_modified(stream, headers);
+            return;
+        }
+
+        LOG_INFO("Server file: {} (size: {} bytes)", send_path, content_length);
+
+        if (!ResponseUtils::send_response_header(
+            stream, HttpStatus::OK, mime_type, content_length, headers)) {
+            return;
+        }
+        if (request.method == "HEAD") {
+            return;
+        }
+        if (compressed) {
+            if (auto ret = stream.write(std::string_view(*compressed)); !ret) {
+                LOG_ERROR("Send compressed file failed: {}", ret.error());
+            }
+        } else {
+            ResponseUtils::send_file_content(stream, send_path);
         }
     }
 
@@ -112,24 +521,132 @@ private:
                 stream, HttpStatus::NOT_FOUND,
                 get_mime_type(not_found_html), strlen(not_found_html))) {
             auto ret = stream.write(not_found_html);
-            if (!ret){}
-            LOG_ERROR("Send 404 response header error: {}", ret.error());
+            if (!ret) {
+                LOG_ERROR("Send 404 response header error: {}", ret.error());
+            }
         }else {
             LOG_ERROR("Send 404 response head failed");
         }
     }
 
-    //解析HTTP请求，提取请求路径
-    static auto parse_http_request(const std::string& request) -> std::string{
-        //简单的请求解析：提取第一个空格和第二个空格之间的路径
-        size_t start = request.find(' ');
-        if (start == std::string::npos) return "/";
-        size_t end = request.find(' ', start+1);
-        if (end == std::string::npos) return "/";
+    //追加校验相关的响应头：ETag、Last-Modified 以及按路由配置的 Cache-Control
+    auto append_validators(HeaderList& headers, const std::string& path, const std::string& etag,
+                           const std::string& last_modified) const -> void{
+        headers.emplace_back("ETag", etag);
+        if (!last_modified.empty()) {
+            headers.emplace_back("Last-Modified", last_modified);
+        }
+        if (auto cache_control = find_cache_control(path); !cache_control.empty()) {
+            headers.emplace_back("Cache-Control", std::string(cache_control));
+        }
+    }
+
+    //按最长前缀匹配查找路由，没有匹配时返回 nullptr
+    auto find_route(const std::string& path) const -> const RouteHandler*{
+        const RouteHandler* best = nullptr;
+        size_t best_len = 0;
+        for (const auto& [prefix, handler] : routes_) {
+            if (path.starts_with(prefix) && prefix.size() >= best_len) {
+                best = &handler;
+                best_len = prefix.size();
+            }
+        }
+        return best;
+    }
+
+    //按完整路径查找嵌入资源，以 '/' 结尾的路径查找其中的 index.html
+    auto find_embedded_asset(const std::string& path) const -> const EmbeddedAsset*{
+        if (embedded_assets_.empty()) return nullptr;
+        auto normalized = normalize_request_path(path);
+        if (!normalized) return nullptr;
+        if (normalized->ends_with('/')) normalized->append("index.html");
+        auto it = embedded_assets_.find(*normalized);
+        return it == embedded_assets_.end() ? nullptr : it->second;
+    }
 
-        return request.substr(start+1, end-start-1);  //提取路径
+    //发送嵌入资源：与内存中的固定内容相同，支持条件请求和压缩缓存
+    auto serve_embedded(net::TcpStream& stream, const HttpRequest& request, const EmbeddedAsset& asset) -> void{
+        if (request.method != "GET" && request.method != "HEAD") {
+            ResponseUtils::send_simple_response(stream, HttpStatus::METHOD_NOT_ALLOWED,
+                "Method not allowed\n", {{"Allow", "GET, HEAD"}});
+            return;
+        }
+        serve_content(stream, request, asset.data, std::string(asset.etag), std::string(asset.mime_type));
     }
 
+    //按最长前缀匹配查找静态文件挂载点（前缀需在路径段边界上匹配），没有匹配时返回 nullptr
+    auto find_static_mount(const std::string& path) const -> const StaticMount*{
+        const StaticMount* best = nullptr;
+        size_t best_len = 0;
+        for (const auto& mount : static_mounts_) {
+            if (strip_mount_prefix(path, mount.url_prefix) && mount.url_prefix.size() >= best_len) {
+                best = &mount;
+                best_len = mount.url_prefix.size();
+            }
+        }
+        return best;
+    }
+
+    //去掉挂载前缀，返回以 '/' 开头的剩余路径；路径不在前缀之下时返回 std::nullopt
+    static auto strip_mount_prefix(std::string_view path, std::string_view prefix) -> std::optional<std::string_view>{
+        if (prefix == "/") return path;
+        if (!path.starts_with(prefix)) return std::nullopt;
+        path.remove_prefix(prefix.size());
+        if (path.empty()) return "/";
+        if (!path.starts_with('/')) return std::nullopt;
+        return path;
+    }
+
+    //按最长前缀匹配查找 Cache-Control 配置
+    auto find_cache_control(const std::string& path) const -> std::string_view{
+        std::string_view best;
+        size_t best_len = 0;
+        for (const auto& [prefix, value] : cache_control_rules_) {
+            if (path.starts_with(prefix) && prefix.size() >= best_len) {
+                best = value;
+                best_len = prefix.size();
+            }
+        }
+        return best;
+    }
+
+    //根据内容计算强ETag（FNV-1a 64位哈希）
+    static auto make_content_etag(std::string_view content) -> std::string{
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : content) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return std::format("\"{:x}-{:x}\"", content.size(), hash);
+    }
+
+    //为编码后的内容生成不同的强ETag，如 "abc" -> "abc-gzip"
+    static auto make_variant_etag(const std::string& etag, std::string_view suffix) -> std::string{
+        std::string variant = etag;
+        variant.insert(variant.size() - 1, std::string("-").append(suffix));
+        return variant;
+    }
+
+    //读取整个文件（仅用于需要压缩的小文件）
+    static auto read_file(const std::string& file_path) -> std::optional<std::string>{
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file) return std::nullopt;
+        return std::string(std::istreambuf_iterator<char>(file), {});
+    }
+
+    std::vector<std::pair<std::string, RouteHandler>> routes_;   //路径前缀 -> 处理函数
+    std::unordered_map<std::string, WebSocketHandler> websocket_handlers_;  //路径 -> WebSocket 处理函数
+    std::vector<std::pair<std::string, std::string>> cache_control_rules_;  //路径前缀 -> Cache-Control
+    std::vector<StaticMount> static_mounts_;   //静态文件挂载点
+    std::unordered_map<std::string, const EmbeddedAsset*> embedded_assets_;   //URL 路径 -> 嵌入资源
+    std::vector<ResponseCacheRule> response_cache_rules_;   //开启响应缓存的路径
+    std::unique_ptr<ResponseCache> response_cache_;         //响应缓存（开启后创建）
+    size_t response_cache_bytes_{64 * 1024 * 1024};        //响应缓存内存上限
+    FileMetaCache file_meta_cache_;   //文件元数据缓存
+    CompressionCache compression_cache_;   //压缩结果缓存
+    size_t max_compress_file_size_{8 * 1024 * 1024};  //即时压缩的文件大小上限
+    std::string upload_dir_{"/tmp"};    //上传文件保存目录
+
 };
 
 }
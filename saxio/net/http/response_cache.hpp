@@ -0,0 +1,227 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include "saxio/net/http/parser.hpp"
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <algorithm>
+
+namespace saxio::http{
+
+//响应缓存规则：路径前缀、有效期以及参与缓存键的请求头
+struct ResponseCacheRule {
+    std::string path_prefix;                //路径前缀（最长前缀匹配）
+    std::chrono::milliseconds ttl;          //缓存有效期
+    std::vector<std::string> vary_headers;  //参与缓存键的请求头（小写）
+};
+
+//序列化响应缓存：保存处理器写出的完整响应（状态行 + 响应头 + 响应体），命中时原样发送
+//
+//按缓存键的哈希分片（默认每个 CPU 核一个分片），每个分片独立加锁、独立做 LRU 淘汰，
+//总内存上限平均分配到各分片。同一个键同时未命中时只有第一个请求执行计算，
+//其余请求等待并复用它的结果（single-flight），突发的相同请求只会回源一次。
+class ResponseCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Payload = std::shared_ptr<const std::string>;
+
+    //计算结果：完整的序列化响应以及是否允许缓存
+    struct Computed {
+        Payload response;
+        bool cacheable{false};
+    };
+
+    explicit ResponseCache(size_t max_bytes = 64 * 1024 * 1024,
+                           size_t shards = std::max(1u, std::thread::hardware_concurrency()))
+        : shards_(shards), max_bytes_per_shard_(std::max<size_t>(max_bytes / shards, 1)){}
+
+    //查找未过期的缓存
+    auto lookup(const std::string& key) -> Payload{
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return find_fresh(shard, key);
+    }
+
+    //查找缓存，未命中时调用 compute 计算；并发的相同未命中只计算一次
+    //compute 的结果不可缓存时，等待中的请求各自重新调用 compute
+    auto get_or_compute(const std::string& key, std::chrono::milliseconds ttl,
+                        const std::function<Computed()>& compute) -> Payload{
+        Shard& shard = shard_for(key);
+        std::shared_ptr<Flight> flight;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (auto hit = find_fresh(shard, key)) {
+                return hit;
+            }
+            auto [it, inserted] = shard.flights.try_emplace(key);
+            if (inserted) {
+                it->second = std::make_shared<Flight>();
+                leader = true;
+            }
+            flight = it->second;
+        }
+
+        if (!leader) {
+            std::unique_lock<std::mutex> lock(flight->mutex);
+            flight->done_cv.wait(lock, [&] { return flight->done; });
+            if (flight->result) {
+                return flight->result;
+            }
+            lock.unlock();
+            return compute().response;
+        }
+
+        Computed computed;
+        try {
+            computed = compute();
+        } catch (...) {
+            //计算失败时同样结束这次计算，等待者各自重新计算，否则它们会一直等待
+            finish_flight(shard, key, *flight, nullptr);
+            throw;
+        }
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (computed.cacheable && computed.response) {
+                insert(shard, key, computed.response, ttl);
+            }
+        }
+        finish_flight(shard, key, *flight, computed.cacheable ? computed.response : nullptr);
+        return computed.response;
+    }
+
+    //删除指定键的缓存
+    auto invalidate(const std::string& key) -> void{
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            erase(shard, it->second);
+        }
+    }
+
+    //清空所有缓存
+    auto clear() -> void{
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    //当前缓存占用的字节数
+    [[nodiscard]]
+    auto size_bytes() -> size_t{
+        size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.bytes;
+        }
+        return total;
+    }
+
+    //单条缓存（键 + 响应）的最大字节数，超过时 insert 不会保存
+    [[nodiscard]]
+    auto max_entry_bytes() const -> size_t{
+        return max_bytes_per_shard_;
+    }
+
+    //判断序列化响应是否可以缓存：只缓存 200，且响应头没有 no-store / private
+    static auto is_cacheable_response(std::string_view response) -> bool{
+        auto head_end = response.find("\r\n\r\n");
+        if (head_end == std::string_view::npos) return false;
+        HttpResponse head = parse_http_response(response.substr(0, head_end + 4));
+        if (head.status != 200) return false;
+        auto cache_control = head.header("cache-control");
+        return !header_has_token(cache_control, "no-store") && !header_has_token(cache_control, "private");
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        Payload response;
+        Clock::time_point expires_at;
+    };
+
+    //正在计算中的未命中
+    struct Flight {
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool done{false};
+        Payload result;   //计算结果不可缓存时为空
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;   //表头为最近使用
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+        size_t bytes{0};
+    };
+
+    auto shard_for(const std::string& key) -> Shard&{
+        return shards_[std::hash<std::string>{}(key) % shards_.size()];
+    }
+
+    //调用方需持有分片的锁
+    auto find_fresh(Shard& shard, const std::string& key) -> Payload{
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return nullptr;
+        if (it->second->expires_at <= Clock::now()) {
+            erase(shard, it->second);
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->response;
+    }
+
+    //调用方需持有分片的锁；超过分片上限时从表尾淘汰
+    auto insert(Shard& shard, const std::string& key, Payload response,
+                std::chrono::milliseconds ttl) -> void{
+        size_t cost = key.size() + response->size();
+        if (cost > max_bytes_per_shard_) return;
+
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            erase(shard, it->second);
+        }
+        while (shard.bytes + cost > max_bytes_per_shard_ && !shard.lru.empty()) {
+            erase(shard, std::prev(shard.lru.end()));
+        }
+        shard.lru.push_front(Entry{key, std::move(response), Clock::now() + ttl});
+        shard.index.emplace(key, shard.lru.begin());
+        shard.bytes += cost;
+    }
+
+    //结束一次计算：移出分片并唤醒等待者，result 为空时等待者各自重新计算
+    auto finish_flight(Shard& shard, const std::string& key, Flight& flight, Payload result) -> void{
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.flights.erase(key);
+        }
+        {
+            std::lock_guard<std::mutex> lock(flight.mutex);
+            flight.done = true;
+            flight.result = std::move(result);
+        }
+        flight.done_cv.notify_all();
+    }
+
+    auto erase(Shard& shard, std::list<Entry>::iterator it) -> void{
+        shard.bytes -= it->key.size() + it->response->size();
+        shard.index.erase(it->key);
+        shard.lru.erase(it);
+    }
+
+    std::vector<Shard> shards_;
+    size_t max_bytes_per_shard_;
+};
+
+}
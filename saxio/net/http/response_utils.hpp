@@ -4,8 +4,12 @@
 #include "saxio/net.hpp"
 #include "saxio/common/debug.hpp"
 #include <sstream>
-#include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
 
 namespace saxio::http{
 
@@ -16,14 +20,20 @@ public:
     static auto send_response_header(net::TcpStream& stream,    //TCP流，代表与客户端的网络连接
                                     HttpStatus status,          //HTTP响应码
                                     const std::string& content_type,     //响应内容MIME类型
-                                    size_t content_length = 0) -> bool{  //响应主体（body）长度
+                                    size_t content_length = 0,          //响应主体（body）长度
+                                    const HeaderList& extra_headers = {}) -> bool{  //额外响应头
         std::ostringstream header;
         header << "HTTP/1.1 " << static_cast<int>(status)
                << " " << get_status_text(status) << "\r\n";
-        header << "Content-Type: " << content_type << "\r\n";
+        if (!content_type.empty()) {
+            header << "Content-Type: " << content_type << "\r\n";
+        }
         if (content_length > 0) {
             header << "Content-Length: " << content_length << "\r\n";
         }
+        for (const auto& [name, value] : extra_headers) {
+            header << name << ": " << value << "\r\n";
+        }
         header << "Connection: close\r\n";
         header << "\r\n";  //空行分隔头部和主体
 
@@ -36,40 +46,98 @@ public:
         return true;
     }
 
-    //发送文件内容到客户端
+    //发送带纯文本响应体的简单响应（多用于错误状态）
+    static auto send_simple_response(net::TcpStream& stream, HttpStatus status,
+                                     std::string_view body,
+                                     const HeaderList& extra_headers = {}) -> bool{
+        if (!send_response_header(stream, status, "text/plain; charset=utf-8",
+                                  body.size(), extra_headers)) {
+            return false;
+        }
+        if (body.empty()) return true;
+        auto result = stream.write(body);
+        if (!result) {
+            LOG_ERROR("Failed to send response body: {}", result.error());
+            return false;
+        }
+        return true;
+    }
+
+    //发送 304 Not Modified 响应（只有响应头，没有响应体）
+    static auto send_not_modified(net::TcpStream& stream,
+                                  const HeaderList& validators) -> bool{
+        return send_response_header(stream, HttpStatus::NOT_MODIFIED, "", 0, validators);
+    }
+
+    //发送文件内容到客户端：优先使用 sendfile() 在内核中直接从页缓存拷贝到套接字，
+    //不支持时（如输出端不接受 sendfile）退回到用户态缓冲区读写
     static auto send_file_content(net::TcpStream& stream,
                                   const std::string& file_path) -> bool{
-        std::ifstream file(file_path, std::ios::binary);  //以二进制模式打开文件
+        io::detail::FD file{::open(file_path.c_str(), O_RDONLY | O_CLOEXEC)};
         //文件不存在
-        if (!file) {
+        if (!file.is_valid()) {
             LOG_ERROR("Failed to open file: {}", file_path);
             return false;
         }
 
-        //线程局部静态缓冲区，每个线程只初始化一次
-        thread_local std::vector<char> buffer(4096);
+        struct stat st{};
+        if (::fstat(file.fd(), &st) < 0) {
+            LOG_ERROR("Failed to stat file: {}", file_path);
+            return false;
+        }
+
+        return send_fd_content(stream, file.fd(), static_cast<size_t>(st.st_size));
+    }
 
-        //使用缓冲区流式传输文件内容
-        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
-            //发送读取的数据（gcount为从文件实际读取的字节数，表示每次读取发送4096字节）
-            auto result = stream.write({buffer.data(),
-                                                            static_cast<size_t>(file.gcount())});
-            if (!result) {
-                LOG_ERROR("Failed to send data: {}", result.error());
+    //从文件描述符的开头发送 size 字节到客户端（读取位置需在开头），同样优先使用 sendfile()
+    static auto send_fd_content(net::TcpStream& stream, int fd, size_t size) -> bool{
+        //单次 sendfile() 最多传输约 2GB，大文件分多次发送
+        off_t offset = 0;
+        size_t remaining = size;
+        while (remaining > 0) {
+            ssize_t sent = ::sendfile(stream.fd(), fd, &offset, std::min<size_t>(remaining, 1 << 30));
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EINVAL || errno == ENOSYS) && offset == 0) {
+                return copy_file_content(stream, fd);
+            }
+            if (sent < 0) {
+                LOG_ERROR("Failed to send file content: {}", strerror(errno));
                 return false;
             }
+            //文件在发送过程中被截断
+            if (sent == 0) break;
+            remaining -= static_cast<size_t>(sent);
         }
+        return true;
+    }
+
+private:
+    //通过用户态缓冲区发送文件剩余内容
+    static auto copy_file_content(net::TcpStream& stream, int file_fd) -> bool{
+        //线程局部静态缓冲区，每个线程只初始化一次
+        thread_local std::vector<char> buffer(64 * 1024);
 
-        //当剩余数据小于缓冲区大小时会退出循环，所以需发送最后一块数据
-        if (file.gcount() > 0) {
-            auto result = stream.write({buffer.data(),
-                                                            static_cast<size_t>(file.gcount())});
-            if (!result) {
-                LOG_ERROR("Failed to send final data: {}", result.error());
+        while (true) {
+            ssize_t n = ::read(file_fd, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                LOG_ERROR("Failed to read file: {}", strerror(errno));
                 return false;
             }
+            if (n == 0) return true;
+
+            //写入可能只完成一部分，循环直到本块全部发出
+            std::span<const char> chunk{buffer.data(), static_cast<size_t>(n)};
+            while (!chunk.empty()) {
+                auto result = stream.write(chunk);
+                if (!result || result.value() == 0) {
+                    LOG_ERROR("Failed to send data: {}",
+                        result ? make_error(Error::kWriteFailed) : result.error());
+                    return false;
+                }
+                chunk = chunk.subspan(result.value());
+            }
         }
-        return true;
     }
 
 };
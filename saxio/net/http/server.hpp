@@ -4,10 +4,20 @@
 
 #include "saxio/net/http/types.hpp"
 #include "saxio/net/http/request_handler.hpp"
+#include "saxio/net/http/parser.hpp"
+#include "saxio/net/http/body_reader.hpp"
 #include "saxio/net/http/client_manager.hpp"
+#include "saxio/net/http/admission.hpp"
+#include "saxio/net/http/rate_limiter.hpp"
+#include "saxio/net/http/h2/connection.hpp"
 #include "saxio/net.hpp"
+#include "saxio/common/affinity.hpp"
 #include "saxio/common/debug.hpp"
 #include <vector>
+#include <csignal>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
 
 namespace saxio::http{
 
@@ -24,7 +34,7 @@ public:
         stop();
     }
 
-    //启动HTTP服务器
+    //启动HTTP服务器：绑定端口后进入服务循环
     auto start() -> saxio::Result<void>{
         sockaddr_in addr{};
         addr.sin_family = AF_INET;
@@ -42,47 +52,179 @@ public:
         auto tcp_listener = std::move(has_listener.value());  //value取出对象
         LOG_INFO("HTTP Server started on port {}, fd is {}",
             ntohs(addr.sin_port), tcp_listener.fd());
+        return serve(tcp_listener);
+    }
+
+    //在已有的监听套接字上提供服务（如 prefork 模式下由 master 进程创建并共享的监听套接字），
+    //stop() 之后返回，返回前等待正在处理的连接结束（最长 drain_timeout）
+    auto serve(net::TcpListener& tcp_listener) -> saxio::Result<void>{
+        //对端关闭后继续写入不应终止进程（HTTP/2 的流桥接依赖这一点）
+        ::signal(SIGPIPE, SIG_IGN);
+
+        //监听套接字可能由多个进程共享：设为非阻塞，连接被其他进程取走时不会阻塞在 accept 中
+        int flags = fcntl(tcp_listener.fd(), F_GETFL, 0);
+        if (flags == -1 || fcntl(tcp_listener.fd(), F_SETFL, flags | O_NONBLOCK) == -1) {
+            return std::unexpected{make_error(Error::kSetNonBlockFailed)};
+        }
 
         //主服务器循环
         while (server_running_) {
-            //只需要建立连接，不需要知道客户端信息，所以用nullptr
-            auto has_stream = tcp_listener.accept(nullptr, nullptr);
+            //定期醒来检查停止标志
+            pollfd pfd{tcp_listener.fd(), POLLIN, 0};
+            if (::poll(&pfd, 1, kAcceptPollMs) <= 0) {
+                continue;
+            }
+
+            //记录客户端地址，用于按 IP 限速
+            sockaddr_in peer{};
+            socklen_t peer_len = sizeof(peer);
+            auto has_stream = tcp_listener.accept(reinterpret_cast<sockaddr*>(&peer), &peer_len);
             if (!has_stream) {
-                LOG_ERROR("Accept failed: {}", has_stream.error());
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    LOG_ERROR("Accept failed: {}", has_stream.error());
+                }
                 continue;   //单个连接失败不影响服务器运行
             }
 
             net::TcpStream stream(std::move(has_stream.value()));
             int client_fd = stream.fd();
+            auto accepted_at = AdmissionControl::Clock::now();
+            uint32_t peer_ip = peer.sin_addr.s_addr;
             LOG_INFO("HTTP Connection accepted {}", client_fd);
 
+            //超出该 IP 的连接速率：回复 429 后关闭
+            if (!rate_limits_.allow_connection(peer_ip)) {
+                LOG_WARN("Connection rate limited for client {}", client_fd);
+                (void)stream.write(rate_limits_.too_many_requests_response());
+                continue;
+            }
+
+            //超出连接数上限：直接写出预先生成的 503，不创建线程
+            if (!admission_.try_accept_connection()) {
+                LOG_WARN("Too many connections ({}), rejecting client {}",
+                    admission_.connection_count(), client_fd);
+                (void)stream.write(admission_.busy_response());
+                continue;
+            }
+
             //清理已完成的客户端连接
             client_manager_.cleanup_finished_client();
 
             //为新客户端创建处理线程
             client_manager_.add_client(client_fd,
-                [this, stream=std::move(stream)]() mutable {
-                    this->process_client(std::move(stream));
+                [this, stream=std::move(stream), accepted_at, peer_ip]() mutable {
+                    //HTTP/2 流的处理线程由连接线程创建，继承同样的绑定
+                    if (auto pinned = affinity_.apply(stream.fd()); !pinned) {
+                        LOG_WARN("Failed to pin HTTP client {}: {}", stream.fd(), pinned.error());
+                    }
+                    this->process_client(std::move(stream), accepted_at, peer_ip);
+                    admission_.release_connection();
                 });
 
             LOG_INFO("HTTP client {} thread started, total clients: {}",
                 client_fd, client_manager_.client_count());
         }
+
+        //不再接受新连接，等待已有连接处理完
+        auto deadline = std::chrono::steady_clock::now() + drain_timeout_;
+        while (client_manager_.client_count() > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        LOG_INFO("HTTP Server stopped, {} clients still running", client_manager_.client_count());
         return {};
     }
 
-    //停止服务器
+    //停止服务器（只修改原子标志，可以在其他线程中调用）
     auto stop() -> void{
         server_running_ = false;
     }
 
+    //停止后等待正在处理的连接结束的最长时间
+    auto set_drain_timeout(std::chrono::milliseconds timeout) -> void{ drain_timeout_ = timeout; }
+
+    //设置请求体最大字节数（Content-Length 超出时直接返回413，chunked 请求体读取时检查）
+    auto set_max_body_size(size_t size) -> void{ max_body_size_ = size; }
+
+    //是否接受明文 HTTP/2（h2c）：prior knowledge 连接序言和 "Upgrade: h2c"，默认开启
+    auto enable_h2c(bool enable) -> void{ h2c_enabled_ = enable; }
+
+    //连接处理线程的 CPU 亲和性，默认不绑定；例如 net::ConnectionAffinity::incoming_node()
+    //让处理线程留在网卡收包 CPU 所在的 NUMA 节点上
+    auto set_connection_affinity(net::ConnectionAffinity affinity) -> void{ affinity_ = std::move(affinity); }
+
+    //获取请求处理器，用于在启动前配置路由相关选项（如 Cache-Control）
+    auto handler() -> RequestHandler&{ return handler_; }
+
+    //获取准入控制，用于配置连接数、并发请求数上限和按排队延迟丢弃
+    auto admission() -> AdmissionControl&{ return admission_; }
+
+    //获取客户端限速配置（按 IP 的连接速率、请求速率和按路由的请求速率）
+    auto rate_limits() -> ClientRateLimits&{ return rate_limits_; }
+
 private:
-    //处理单个客户端连接的函数
-    auto process_client(net::TcpStream stream) -> void{
-        thread_local std::vector<char> buf(4096);
+    //处理单个客户端连接的函数，arrived_at 为请求开始排队的时间（用于准入控制），peer_ip 用于限速
+    auto process_client(net::TcpStream stream, AdmissionControl::Clock::time_point arrived_at,
+                        uint32_t peer_ip) -> void{
         int client_fd = stream.fd();
-
         LOG_INFO("Start processing HTTP client: {}", client_fd);
+        //等待线程调度的时间计入排队时间，读取请求头的时间取决于客户端，不计入
+        auto scheduling_delay = AdmissionControl::Clock::now() - arrived_at;
+
+        //读取请求头，多读到的数据属于请求体
+        std::string data;
+        if (auto head_size = read_request_head(stream, data); head_size > 0) {
+            arrived_at = AdmissionControl::Clock::now() - scheduling_delay;
+            std::string_view head{data.data(), head_size};
+            HttpRequest request = parse_http_request(head);
+
+            //清理请求显示：只显示第一行（请求行）
+            LOG_DEBUG("Received HTTP request from client {}: {}",
+                client_fd, head.substr(0, head.find("\r\n")));
+
+            if (request.method.empty()) {
+                ResponseUtils::send_simple_response(stream, HttpStatus::BAD_REQUEST, "Bad request\n");
+            } else if (h2c_enabled_ && request.method == "PRI" && request.path == "*"
+                       && request.version == "HTTP/2.0") {
+                //HTTP/2 连接序言的前半部分恰好被当作请求头解析，剩余部分由连接继续校验
+                h2::Connection connection{stream, stream_spawner(peer_ip), server_running_};
+                connection.serve(data.substr(head_size), "SM\r\n\r\n");
+            } else if (h2c_enabled_ && is_h2c_upgrade(request)) {
+                h2::Connection connection{stream, stream_spawner(peer_ip), server_running_};
+                if (!connection.serve_upgrade(request, data.substr(head_size))) {
+                    admit_and_dispatch(stream, request, data.substr(head_size), arrived_at, peer_ip);
+                }
+            } else {
+                admit_and_dispatch(stream, request, data.substr(head_size), arrived_at, peer_ip);
+            }
+        }
+
+        //清理客户端资源
+        client_manager_.remove_client(client_fd);
+    }
+
+    //带请求体的升级请求不处理（需要先读完请求体），按 HTTP/1.1 响应
+    static auto is_h2c_upgrade(const HttpRequest& request) -> bool{
+        return header_has_token(request.header("upgrade"), "h2c")
+            && !request.header("http2-settings").empty()
+            && request.header("transfer-encoding").empty()
+            && (request.header("content-length").empty() || request.header("content-length") == "0");
+    }
+
+    //HTTP/2 的每个流在独立线程中按 HTTP/1.1 流程处理，与普通连接一样由 ClientManager 管理
+    auto stream_spawner(uint32_t peer_ip) -> h2::Connection::StreamSpawner{
+        return [this, peer_ip](net::TcpStream stream) {
+            int stream_fd = stream.fd();
+            auto arrived_at = AdmissionControl::Clock::now();
+            client_manager_.add_client(stream_fd, [this, stream=std::move(stream), arrived_at, peer_ip]() mutable {
+                this->process_client(std::move(stream), arrived_at, peer_ip);
+            });
+        };
+    }
+
+    //读取请求头直到空行，返回请求头长度（含结尾的空行），连接关闭或出错时返回0
+    auto read_request_head(net::TcpStream& stream, std::string& data) -> size_t{
+        thread_local std::vector<char> buf(4096);
+        int client_fd = stream.fd();
 
         while (server_running_) {
             //读取客户端请求
@@ -94,43 +236,102 @@ private:
                 }else {
                     LOG_ERROR("Recv failed: {} - {}", client_fd, read_result.error());
                 }
-                break;
+                return 0;
             }
 
             auto bytes_read = read_result.value();
             if (bytes_read == 0) {
                 LOG_INFO("Client closed connection: {}", client_fd);
-                break;
+                return 0;
             }
 
-            std::string request{buf.data(), bytes_read};
-
-            //清理请求显示：只显示第一行（请求行）
-            size_t first_newline = request.find('\n');
-            if (first_newline != std::string::npos) {
-                std::string request_line = request.substr(0, first_newline);
-                //移除回车符
-                if (!request_line.empty() && request_line.back() == '\r') {
-                    request_line.pop_back();
-                }
-                LOG_DEBUG("Received HTTP request from client {}: {}", client_fd, request_line);
-            } else {
-                LOG_DEBUG("Received HTTP request from client {}: {}", client_fd, request);
+            //从上次结尾往前3个字节开始查找，空行可能被拆分在两次读取之间
+            size_t search_from = data.size() < 3 ? 0 : data.size() - 3;
+            data.append(buf.data(), bytes_read);
+            if (auto pos = data.find("\r\n\r\n", search_from); pos != std::string::npos) {
+                return pos + 4;
             }
+            if (data.size() > kMaxHeaderSize) {
+                LOG_WARN("Request header too large from client {}", client_fd);
+                ResponseUtils::send_simple_response(stream,
+                    HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE, "Request header too large\n");
+                return 0;
+            }
+        }
+        return 0;
+    }
 
-            //处理HTTP请求
-            RequestHandler::handle_request(stream, request);
-            break;   //HTTP/1.0 简单处理，请求每个请求后关闭连接
+    //检查限速并申请处理名额后分发请求；被拒绝的请求直接收到预先生成的 429 或 503
+    auto admit_and_dispatch(net::TcpStream& stream, const HttpRequest& request, std::string buffered,
+                            AdmissionControl::Clock::time_point arrived_at, uint32_t peer_ip) -> void{
+        if (!rate_limits_.allow_request(peer_ip, request.path)) {
+            LOG_WARN("Request rate limited: {} {}", request.method, request.path);
+            (void)stream.write(rate_limits_.too_many_requests_response());
+            return;
+        }
+        if (!admission_.admit_request(arrived_at)) {
+            LOG_WARN("Server overloaded, shedding request {} {}", request.method, request.path);
+            (void)stream.write(admission_.busy_response());
+            return;
         }
+        dispatch(stream, request, std::move(buffered));
+        admission_.release_request();
+    }
 
-        //清理客户端资源
-        client_manager_.remove_client(client_fd);
+    //确定请求体的分帧方式后交给请求处理器
+    auto dispatch(net::TcpStream& stream, const HttpRequest& request, std::string buffered) -> void{
+        auto framing = BodyReader::Framing::NONE;
+        size_t content_length = 0;
+        auto transfer_encoding = request.header("transfer-encoding");
+        auto content_length_str = request.header("content-length");
+
+        if (!transfer_encoding.empty()) {
+            //同时出现两者可能是请求走私，直接拒绝（RFC 7230 3.3.3）
+            if (!content_length_str.empty()) {
+                ResponseUtils::send_simple_response(stream, HttpStatus::BAD_REQUEST, "Bad request\n");
+                return;
+            }
+            if (!header_has_token(transfer_encoding, "chunked")) {
+                ResponseUtils::send_simple_response(stream, HttpStatus::NOT_IMPLEMENTED,
+                    "Unsupported transfer encoding\n");
+                return;
+            }
+            framing = BodyReader::Framing::CHUNKED;
+        } else if (!content_length_str.empty()) {
+            auto length = parse_content_length(content_length_str);
+            if (!length) {
+                ResponseUtils::send_simple_response(stream, HttpStatus::BAD_REQUEST, "Bad request\n");
+                return;
+            }
+            //在发送 100 Continue 之前拒绝过大的请求体，客户端无需上传
+            if (length.value() > max_body_size_) {
+                LOG_WARN("Request body too large: {} bytes", length.value());
+                ResponseUtils::send_simple_response(stream, HttpStatus::PAYLOAD_TOO_LARGE, "Body too large\n");
+                return;
+            }
+            framing = BodyReader::Framing::CONTENT_LENGTH;
+            content_length = length.value();
+        }
+
+        BodyReader body{stream, std::move(buffered), framing, content_length, max_body_size_};
+        body.set_expect_continue(header_has_token(request.header("expect"), "100-continue"));
+
+        //处理HTTP请求（HTTP/1.0 简单处理，请求每个请求后关闭连接）
+        handler_.handle_request(stream, request, body);
     }
 
+    static constexpr int kAcceptPollMs = 500;   //accept 循环检查停止标志的间隔
 
     uint16_t port_;     //服务器监听端口
     std::atomic<bool> server_running_{true};  //服务器运行状态标志
     ClientManager client_manager_;      //客户端连接管理器
+    RequestHandler handler_;            //请求处理器
+    AdmissionControl admission_;        //准入控制
+    ClientRateLimits rate_limits_;      //客户端限速
+    size_t max_body_size_{8 * 1024 * 1024};  //请求体最大字节数
+    bool h2c_enabled_{true};            //是否接受 h2c
+    net::ConnectionAffinity affinity_;  //连接处理线程的 CPU 亲和性
+    std::chrono::milliseconds drain_timeout_{std::chrono::seconds(30)};  //停止时等待连接结束的最长时间
 };
 
 }
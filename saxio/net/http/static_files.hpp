@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+namespace saxio::http{
+
+//静态文件目录挂载：URL 前缀 -> 文档根目录
+struct StaticMount {
+    std::string url_prefix;                //URL 前缀，如 "/" 或 "/assets"
+    std::string document_root;             //文档根目录（不以 '/' 结尾）
+    std::vector<std::string> index_files;  //访问目录时依次尝试的索引文件
+};
+
+//解码 URL 中的百分号编码，格式非法或解码出 NUL 时返回 std::nullopt
+inline auto percent_decode(std::string_view in) -> std::optional<std::string>{
+    auto hex = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        char c = in[i];
+        if (c == '%') {
+            if (i + 2 >= in.size()) return std::nullopt;
+            int hi = hex(in[i + 1]);
+            int lo = hex(in[i + 2]);
+            if (hi < 0 || lo < 0) return std::nullopt;
+            c = static_cast<char>(hi * 16 + lo);
+            i += 2;
+        }
+        if (c == '\0') return std::nullopt;
+        out.push_back(c);
+    }
+    return out;
+}
+
+//规范化请求路径：去掉查询串，解码百分号编码，合并重复的 '/'，解析 "." 和 ".."
+//".." 越过根目录（目录穿越）时返回 std::nullopt；结果以 '/' 开头，保留结尾的 '/'
+inline auto normalize_request_path(std::string_view target) -> std::optional<std::string>{
+    target = target.substr(0, target.find_first_of("?#"));
+    auto decoded = percent_decode(target);
+    if (!decoded || !decoded->starts_with('/') || decoded->find('\\') != std::string::npos) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string_view> segments;
+    std::string_view rest = *decoded;
+    bool trailing_slash = rest.ends_with('/');
+    while (!rest.empty()) {
+        size_t slash = rest.find('/');
+        std::string_view segment = rest.substr(0, slash);
+        rest = slash == std::string_view::npos ? std::string_view{} : rest.substr(slash + 1);
+
+        if (segment.empty() || segment == ".") continue;
+        if (segment == "..") {
+            if (segments.empty()) return std::nullopt;
+            segments.pop_back();
+            continue;
+        }
+        segments.push_back(segment);
+    }
+
+    std::string path;
+    for (auto segment : segments) {
+        path.append("/").append(segment);
+    }
+    if (path.empty() || trailing_slash) path.push_back('/');
+    return path;
+}
+
+}
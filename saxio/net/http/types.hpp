@@ -1,44 +1,141 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <ctime>
+#include <cctype>
+
 namespace saxio::http{
 
 //HTTP响应状态码枚举
 enum class HttpStatus {
+    SWITCHING_PROTOCOLS = 101,  //切换协议（如 WebSocket 升级）
     OK = 200,    //请求成功
+    CREATED = 201,  //资源已创建
+    MOVED_PERMANENTLY = 301,  //永久重定向（如目录补全结尾的 '/'）
+    NOT_MODIFIED = 304,  //资源未修改（条件请求命中）
+    BAD_REQUEST = 400,  //请求格式错误
     NOT_FOUND = 404,  //资源未找到
+    METHOD_NOT_ALLOWED = 405,  //请求方法不被允许
+    PAYLOAD_TOO_LARGE = 413,   //请求体过大
+    UPGRADE_REQUIRED = 426,    //需要升级协议（如不支持的 WebSocket 版本）
+    TOO_MANY_REQUESTS = 429,   //超出客户端限速
+    REQUEST_HEADER_FIELDS_TOO_LARGE = 431,  //请求头过大
     INTERNAL_ERROR = 500,  //服务器内部错误
+    NOT_IMPLEMENTED = 501, //不支持的功能（如未知的传输编码）
+    BAD_GATEWAY = 502,     //上游服务器响应无效或无法连接
+    SERVICE_UNAVAILABLE = 503,  //服务暂不可用（如没有可用的上游服务器）
+    GATEWAY_TIMEOUT = 504,      //上游服务器响应超时
 };
 
+//额外响应头列表（保持插入顺序）
+using HeaderList = std::vector<std::pair<std::string, std::string>>;
+
 //HTTP请求结构体
 struct HttpRequest {
     std::string method;   //请求方法（GET，POST等）
     std::string path;     //请求路径
     std::string version;  //HTTP 版本
+    std::unordered_map<std::string, std::string> headers;  //请求头（键统一转为小写）
+
+    //获取请求头的值，不存在时返回空串
+    [[nodiscard]]
+    auto header(const std::string& name) const -> std::string_view{
+        if (auto it = headers.find(name); it != headers.end()) {
+            return it->second;
+        }
+        return {};
+    }
+};
+
+//HTTP响应头结构体（状态行 + 响应头，不含响应体）
+struct HttpResponse {
+    std::string version;  //HTTP 版本
+    int status{0};        //状态码
+    std::string reason;   //状态描述
+    std::unordered_map<std::string, std::string> headers;  //响应头（键统一转为小写，重复的字段用逗号合并）
+    HeaderList fields;    //按出现顺序的全部响应头（键转为小写），重复的字段不合并，转发时使用
+
+    //获取响应头的值，不存在时返回空串
+    [[nodiscard]]
+    auto header(const std::string& name) const -> std::string_view{
+        if (auto it = headers.find(name); it != headers.end()) {
+            return it->second;
+        }
+        return {};
+    }
 };
 
 //获取状态码的文本描述
 inline auto get_status_text(const HttpStatus status) -> std::string {
     switch(status) {
+        case HttpStatus::SWITCHING_PROTOCOLS: return "Switching Protocols";
         case HttpStatus::OK: return "OK";
+        case HttpStatus::CREATED: return "Created";
+        case HttpStatus::MOVED_PERMANENTLY: return "Moved Permanently";
+        case HttpStatus::NOT_MODIFIED: return "Not Modified";
+        case HttpStatus::BAD_REQUEST: return "Bad Request";
         case HttpStatus::NOT_FOUND: return "Not Found";
+        case HttpStatus::METHOD_NOT_ALLOWED: return "Method Not Allowed";
+        case HttpStatus::PAYLOAD_TOO_LARGE: return "Payload Too Large";
+        case HttpStatus::UPGRADE_REQUIRED: return "Upgrade Required";
+        case HttpStatus::TOO_MANY_REQUESTS: return "Too Many Requests";
+        case HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE: return "Request Header Fields Too Large";
         case HttpStatus::INTERNAL_ERROR: return "Internal Error";
+        case HttpStatus::NOT_IMPLEMENTED: return "Not Implemented";
+        case HttpStatus::BAD_GATEWAY: return "Bad Gateway";
+        case HttpStatus::SERVICE_UNAVAILABLE: return "Service Unavailable";
+        case HttpStatus::GATEWAY_TIMEOUT: return "Gateway Timeout";
         default: return "UNKNOWN";
     }
 }
 
-// 根据文件路径获取MIME类型(主类型/子类型)
+// 根据文件路径获取MIME类型(主类型/子类型)，按扩展名（不区分大小写）查表
 inline auto get_mime_type(const std::string& path) -> std::string{
-    //ends_with：比较字符串末尾是否和指定的后缀一致
-    if (path.ends_with(".html") || path.ends_with(".htm")) return "text/html";
-    if (path.ends_with(".jpg") || path.ends_with("jpeg")) return "image/jpeg";
-    if (path.ends_with(".png")) return "image/png";
-    if (path.ends_with(".gif")) return "image/gif";
-    if (path.ends_with(".txt")) return "text/plain";
-    if (path.ends_with(".css")) return "text/css";
-    if (path.ends_with(".js")) return "application/javascript";
+    static const std::unordered_map<std::string_view, std::string_view> mime_types{
+        {"html", "text/html"}, {"htm", "text/html"},
+        {"css", "text/css"}, {"txt", "text/plain"}, {"csv", "text/csv"}, {"md", "text/markdown"},
+        {"js", "application/javascript"}, {"mjs", "application/javascript"},
+        {"json", "application/json"}, {"map", "application/json"}, {"xml", "application/xml"},
+        {"wasm", "application/wasm"}, {"pdf", "application/pdf"}, {"zip", "application/zip"},
+        {"jpg", "image/jpeg"}, {"jpeg", "image/jpeg"}, {"png", "image/png"}, {"gif", "image/gif"},
+        {"svg", "image/svg+xml"}, {"webp", "image/webp"}, {"avif", "image/avif"}, {"ico", "image/x-icon"},
+        {"woff", "font/woff"}, {"woff2", "font/woff2"}, {"ttf", "font/ttf"}, {"otf", "font/otf"},
+        {"mp3", "audio/mpeg"}, {"ogg", "audio/ogg"}, {"mp4", "video/mp4"}, {"webm", "video/webm"},
+    };
+
+    //只看最后一个路径段中的扩展名
+    size_t dot = path.rfind('.');
+    if (dot != std::string::npos && path.find('/', dot) == std::string::npos) {
+        std::string ext = path.substr(dot + 1);
+        for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (auto it = mime_types.find(ext); it != mime_types.end()) {
+            return std::string(it->second);
+        }
+    }
     return "application/octet-stream";  //默认的二进制流类型
 }
 
+//将时间戳格式化为HTTP日期（RFC 7231 IMF-fixdate），如 "Sun, 06 Nov 1994 08:49:37 GMT"
+inline auto format_http_date(std::time_t time) -> std::string{
+    std::tm tm{};
+    gmtime_r(&time, &tm);
+    char buf[64];
+    auto n = std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return {buf, n};
+}
+
+//解析HTTP日期，失败时返回-1
+inline auto parse_http_date(std::string_view date) -> std::time_t{
+    std::tm tm{};
+    std::string str{date};
+    if (strptime(str.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm) == nullptr) {
+        return -1;
+    }
+    return timegm(&tm);
+}
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,515 @@
+#pragma once
+
+#include "saxio/net/http/types.hpp"
+#include "saxio/net/http/parser.hpp"
+#include "saxio/net/http/response_utils.hpp"
+#include "saxio/net.hpp"
+#include "saxio/common/debug.hpp"
+#include "saxio/common/util/base64.hpp"
+#include "saxio/common/util/sha1.hpp"
+#include <sys/uio.h>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace saxio::http{
+
+namespace ws {
+
+//帧操作码（RFC 6455 5.2）
+enum class Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA,
+};
+
+//关闭状态码（RFC 6455 7.4.1）
+enum class CloseCode : uint16_t {
+    NORMAL = 1000,
+    GOING_AWAY = 1001,
+    PROTOCOL_ERROR = 1002,
+    UNSUPPORTED_DATA = 1003,
+    NO_STATUS = 1005,         //仅用于本地表示"关闭帧中没有状态码"，不能出现在帧中
+    INVALID_PAYLOAD = 1007,
+    POLICY_VIOLATION = 1008,
+    MESSAGE_TOO_BIG = 1009,
+    INTERNAL_ERROR = 1011,
+};
+
+//握手时用于计算 Sec-WebSocket-Accept 的固定 GUID
+inline constexpr std::string_view kHandshakeGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+//根据 Sec-WebSocket-Key 计算 Sec-WebSocket-Accept
+inline auto make_accept_key(std::string_view key) -> std::string{
+    std::string input{key};
+    input += kHandshakeGuid;
+    auto digest = util::sha1(input);
+    return util::base64_encode({reinterpret_cast<const char*>(digest.data()), digest.size()});
+}
+
+//对负载应用掩码（掩码与解掩码是同一个异或操作）
+//offset 为 data 在整个帧负载中的位置，用于分段处理同一帧
+inline auto apply_mask(char* data, size_t size, std::array<uint8_t, 4> mask, size_t offset = 0) -> void{
+    //把掩码旋转到与 data 起始位置对齐，之后按4字节周期重复
+    uint8_t m[4];
+    for (size_t i = 0; i < 4; ++i) m[i] = mask[(offset + i) % 4];
+    uint32_t mask32;
+    std::memcpy(&mask32, m, 4);
+
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_set1_epi32(static_cast<int>(mask32));
+    for (; i + 32 <= size; i += 32) {
+        auto* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), mask256));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i mask128 = _mm_set1_epi32(static_cast<int>(mask32));
+    for (; i + 16 <= size; i += 16) {
+        auto* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), mask128));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t mask128 = vreinterpretq_u8_u32(vdupq_n_u32(mask32));
+    for (; i + 16 <= size; i += 16) {
+        auto* p = reinterpret_cast<uint8_t*>(data + i);
+        vst1q_u8(p, veorq_u8(vld1q_u8(p), mask128));
+    }
+#endif
+    //没有 SIMD 时按8字节处理
+    const uint64_t mask64 = static_cast<uint64_t>(mask32) << 32 | mask32;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        word ^= mask64;
+        std::memcpy(data + i, &word, 8);
+    }
+    for (; i < size; ++i) data[i] = static_cast<char>(data[i] ^ m[i % 4]);
+}
+
+//校验 UTF-8 编码（文本消息必须是合法的 UTF-8），ASCII 部分按8字节快速跳过
+inline auto is_valid_utf8(std::string_view text) -> bool{
+    const auto* p = reinterpret_cast<const uint8_t*>(text.data());
+    size_t size = text.size(), i = 0;
+    while (i < size) {
+        if (i + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, p + i, 8);
+            if ((word & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        uint8_t c = p[i];
+        if (c < 0x80) { ++i; continue; }
+
+        size_t n;
+        uint32_t code;
+        if ((c & 0xe0) == 0xc0) { n = 1; code = c & 0x1f; }
+        else if ((c & 0xf0) == 0xe0) { n = 2; code = c & 0x0f; }
+        else if ((c & 0xf8) == 0xf0) { n = 3; code = c & 0x07; }
+        else return false;
+        if (i + n >= size) return false;
+        for (size_t k = 1; k <= n; ++k) {
+            if ((p[i + k] & 0xc0) != 0x80) return false;
+            code = code << 6 | (p[i + k] & 0x3f);
+        }
+        //拒绝过长编码、代理项和超出 Unicode 范围的码点
+        static constexpr uint32_t kMinCode[] = {0, 0x80, 0x800, 0x10000};
+        if (code < kMinCode[n] || (code >= 0xd800 && code <= 0xdfff) || code > 0x10ffff) return false;
+        i += n + 1;
+    }
+    return true;
+}
+
+}
+
+//WebSocket 消息
+struct WebSocketMessage {
+    ws::Opcode type{ws::Opcode::TEXT};   //TEXT、BINARY、PONG 或 CLOSE
+    std::string data;                    //消息内容（CLOSE 时为关闭原因）
+    ws::CloseCode close_code{ws::CloseCode::NO_STATUS};  //CLOSE 时的状态码
+};
+
+//基于 TcpStream 的 WebSocket 连接（RFC 6455），提供面向消息的收发接口
+//接收时自动处理分片、PING（回复 PONG）和关闭握手；发送可以在其它线程进行（内部加锁）
+class WebSocket {
+public:
+    //连接角色：客户端发送的帧必须加掩码，服务端发送的帧不能加掩码
+    enum class Role { SERVER, CLIENT };
+
+    static constexpr size_t kDefaultMaxMessageSize = 16 * 1024 * 1024;
+
+    /**
+     * @param stream   已完成握手的连接
+     * @param buffered 握手时多读到的数据（属于第一个帧）
+     */
+    explicit WebSocket(net::TcpStream& stream, std::string buffered = {}, Role role = Role::SERVER)
+        : stream_(stream), buffer_(std::move(buffered)), role_(role){}
+
+    //判断请求是否为 WebSocket 升级请求
+    static auto is_upgrade_request(const HttpRequest& request) -> bool{
+        return header_has_token(request.header("upgrade"), "websocket")
+            && header_has_token(request.header("connection"), "upgrade");
+    }
+
+    //完成服务端握手：校验升级请求并发送 101 响应
+    //请求不合法时发送 400（版本不支持时发送 426）并返回错误
+    static auto accept(net::TcpStream& stream, const HttpRequest& request) -> Result<void>{
+        auto key = request.header("sec-websocket-key");
+        auto decoded = util::base64_decode(key);
+        if (request.method != "GET" || !is_upgrade_request(request) || !decoded || decoded->size() != 16) {
+            ResponseUtils::send_simple_response(stream, HttpStatus::BAD_REQUEST, "Bad WebSocket handshake\n");
+            return std::unexpected{make_error(Error::kHttpBadRequest)};
+        }
+        if (request.header("sec-websocket-version") != "13") {
+            ResponseUtils::send_simple_response(stream, HttpStatus::UPGRADE_REQUIRED,
+                "Unsupported WebSocket version\n", {{"Sec-WebSocket-Version", "13"}});
+            return std::unexpected{make_error(Error::kHttpBadRequest)};
+        }
+
+        std::string response = std::format(
+            "HTTP/1.1 101 Switching Protocols\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Accept: {}\r\n\r\n", ws::make_accept_key(key));
+        if (auto ret = stream.write(response); !ret) {
+            LOG_ERROR("Send WebSocket handshake failed: {}", ret.error());
+            return std::unexpected{ret.error()};
+        }
+        return {};
+    }
+
+    //设置接收消息的最大长度，超过时以 1009 关闭连接
+    auto set_max_message_size(size_t size) -> void{ max_message_size_ = size; }
+
+    //设置发送时单个帧的最大负载，超过的消息被拆成多个分片（0 表示不拆分）
+    auto set_max_frame_size(size_t size) -> void{ max_frame_size_ = size; }
+
+    //连接是否已经关闭（收到或发送了关闭帧）
+    [[nodiscard]]
+    auto closed() const noexcept -> bool{ return close_received_ || close_sent_; }
+
+    //接收下一条消息（TEXT、BINARY、PONG 或 CLOSE）
+    //收到 CLOSE 时已自动回复关闭帧；协议错误时以相应状态码关闭连接并返回错误
+    [[nodiscard]]
+    auto receive() -> Result<WebSocketMessage>{
+        if (close_received_) {
+            return std::unexpected{make_error(Error::kWebSocketClosed)};
+        }
+
+        WebSocketMessage message;
+        bool fragmented = false;
+        while (true) {
+            FrameHeader header;
+            if (auto ret = read_frame_header(header); !ret) {
+                return std::unexpected{ret.error()};
+            }
+
+            if (is_control(header.opcode)) {
+                std::string payload(header.length, '\0');
+                if (auto ret = read_payload(header, payload.data()); !ret) {
+                    return std::unexpected{ret.error()};
+                }
+                if (header.opcode == ws::Opcode::PING) {
+                    if (auto ret = send(ws::Opcode::PONG, payload); !ret) {
+                        return std::unexpected{ret.error()};
+                    }
+                    continue;
+                }
+                if (header.opcode == ws::Opcode::PONG) {
+                    //分片消息中间收到的 PONG 直接忽略，避免打断消息
+                    if (fragmented) continue;
+                    return WebSocketMessage{ws::Opcode::PONG, std::move(payload)};
+                }
+                return on_close(payload);
+            }
+
+            //数据帧：CONTINUATION 只能出现在分片消息中，新消息不能打断分片消息
+            if ((header.opcode == ws::Opcode::CONTINUATION) != fragmented) {
+                return fail(ws::CloseCode::PROTOCOL_ERROR);
+            }
+            if (header.opcode != ws::Opcode::CONTINUATION) {
+                message.type = header.opcode;
+            }
+            if (message.data.size() + header.length > max_message_size_) {
+                return fail(ws::CloseCode::MESSAGE_TOO_BIG);
+            }
+
+            size_t old_size = message.data.size();
+            message.data.resize(old_size + header.length);
+            if (auto ret = read_payload(header, message.data.data() + old_size); !ret) {
+                return std::unexpected{ret.error()};
+            }
+
+            if (header.fin) {
+                if (message.type == ws::Opcode::TEXT && !ws::is_valid_utf8(message.data)) {
+                    return fail(ws::CloseCode::INVALID_PAYLOAD);
+                }
+                return message;
+            }
+            fragmented = true;
+        }
+    }
+
+    //发送文本消息
+    auto send_text(std::string_view text) -> Result<void>{ return send_message(ws::Opcode::TEXT, text); }
+
+    //发送二进制消息
+    auto send_binary(std::string_view data) -> Result<void>{ return send_message(ws::Opcode::BINARY, data); }
+
+    //发送 PING（负载不超过125字节）
+    auto ping(std::string_view payload = {}) -> Result<void>{ return send(ws::Opcode::PING, payload.substr(0, 125)); }
+
+    //发起关闭握手；之后仍可调用 receive() 等待对端的关闭帧
+    auto close(ws::CloseCode code = ws::CloseCode::NORMAL, std::string_view reason = {}) -> Result<void>{
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        return send_close_locked(code, reason);
+    }
+
+private:
+    struct FrameHeader {
+        bool fin{false};
+        ws::Opcode opcode{ws::Opcode::TEXT};
+        bool masked{false};
+        std::array<uint8_t, 4> mask{};
+        uint64_t length{0};
+    };
+
+    static auto is_control(ws::Opcode opcode) -> bool{
+        return static_cast<uint8_t>(opcode) & 0x8;
+    }
+
+    //协议错误：发送关闭帧后返回错误
+    auto fail(ws::CloseCode code) -> Result<WebSocketMessage>{
+        LOG_WARN("WebSocket protocol error on fd {}: close code {}", stream_.fd(), static_cast<int>(code));
+        (void)close(code);
+        close_received_ = true;
+        return std::unexpected{make_error(Error::kWebSocketProtocolError)};
+    }
+
+    //收到关闭帧：回复关闭帧（如果还没发送过）并返回 CLOSE 消息
+    auto on_close(const std::string& payload) -> Result<WebSocketMessage>{
+        WebSocketMessage message{ws::Opcode::CLOSE, {}, ws::CloseCode::NO_STATUS};
+        if (payload.size() == 1) return fail(ws::CloseCode::PROTOCOL_ERROR);
+        if (payload.size() >= 2) {
+            auto code = static_cast<uint16_t>(static_cast<uint8_t>(payload[0]) << 8 | static_cast<uint8_t>(payload[1]));
+            //1005、1006、1015 等只用于本地表示，不能出现在关闭帧中
+            bool valid = (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011) || (code >= 3000 && code <= 4999);
+            if (!valid) return fail(ws::CloseCode::PROTOCOL_ERROR);
+            message.close_code = static_cast<ws::CloseCode>(code);
+            message.data = payload.substr(2);
+            if (!ws::is_valid_utf8(message.data)) return fail(ws::CloseCode::INVALID_PAYLOAD);
+        }
+        close_received_ = true;
+
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (!close_sent_) {
+            auto code = message.close_code == ws::CloseCode::NO_STATUS ? ws::CloseCode::NORMAL : message.close_code;
+            (void)send_close_locked(code, {});
+        }
+        return message;
+    }
+
+    //读取并校验帧头
+    auto read_frame_header(FrameHeader& header) -> Result<void>{
+        char head[2];
+        if (auto ret = read_exact(head, 2); !ret) return ret;
+        auto b0 = static_cast<uint8_t>(head[0]), b1 = static_cast<uint8_t>(head[1]);
+        header.fin = b0 & 0x80;
+        header.opcode = static_cast<ws::Opcode>(b0 & 0x0f);
+        header.masked = b1 & 0x80;
+        header.length = b1 & 0x7f;
+
+        //没有协商扩展，RSV 位必须为0；未知操作码视为协议错误
+        auto op = static_cast<uint8_t>(header.opcode);
+        if ((b0 & 0x70) != 0 || (op > 0x2 && op < 0x8) || op > 0xA) {
+            return error_of(fail(ws::CloseCode::PROTOCOL_ERROR));
+        }
+        //控制帧不能分片，负载不超过125字节
+        if (is_control(header.opcode) && (!header.fin || header.length > 125)) {
+            return error_of(fail(ws::CloseCode::PROTOCOL_ERROR));
+        }
+        //客户端发往服务端的帧必须加掩码，反之不能加掩码
+        if (header.masked != (role_ == Role::SERVER)) {
+            return error_of(fail(ws::CloseCode::PROTOCOL_ERROR));
+        }
+
+        if (header.length >= 126) {
+            char ext[8];
+            size_t n = header.length == 126 ? 2 : 8;
+            if (auto ret = read_exact(ext, n); !ret) return ret;
+            header.length = 0;
+            for (size_t i = 0; i < n; ++i) header.length = header.length << 8 | static_cast<uint8_t>(ext[i]);
+            if (header.length > max_message_size_) {
+                return error_of(fail(ws::CloseCode::MESSAGE_TOO_BIG));
+            }
+        }
+        if (header.masked) {
+            if (auto ret = read_exact(reinterpret_cast<char*>(header.mask.data()), 4); !ret) return ret;
+        }
+        return {};
+    }
+
+    static auto error_of(const Result<WebSocketMessage>& result) -> Result<void>{
+        return std::unexpected{result.error()};
+    }
+
+    //读取帧负载并解掩码
+    auto read_payload(const FrameHeader& header, char* dst) -> Result<void>{
+        if (auto ret = read_exact(dst, header.length); !ret) return ret;
+        if (header.masked) ws::apply_mask(dst, header.length, header.mask);
+        return {};
+    }
+
+    //读取恰好 n 个字节：先消耗缓冲区，之后直接读入目标内存，小块数据经缓冲区读取以减少系统调用
+    auto read_exact(char* dst, size_t n) -> Result<void>{
+        while (n > 0) {
+            if (pos_ < buffer_.size()) {
+                size_t count = std::min(n, buffer_.size() - pos_);
+                std::memcpy(dst, buffer_.data() + pos_, count);
+                pos_ += count;
+                dst += count;
+                n -= count;
+                continue;
+            }
+            buffer_.clear();
+            pos_ = 0;
+
+            Result<size_t> ret = 0;
+            if (n >= kReadBufferSize) {
+                ret = stream_.read({dst, n});
+                if (ret && ret.value() > 0) {
+                    dst += ret.value();
+                    n -= ret.value();
+                    continue;
+                }
+            } else {
+                buffer_.resize(kReadBufferSize);
+                ret = stream_.read({buffer_.data(), buffer_.size()});
+                buffer_.resize(ret ? ret.value() : 0);
+            }
+            if (!ret) return std::unexpected{ret.error()};
+            if (ret.value() == 0) {
+                close_received_ = true;
+                return std::unexpected{make_error(Error::kWebSocketClosed)};
+            }
+        }
+        return {};
+    }
+
+    //发送一条消息，按 max_frame_size_ 拆分为多个分片
+    auto send_message(ws::Opcode opcode, std::string_view data) -> Result<void>{
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (close_sent_) return std::unexpected{make_error(Error::kWebSocketClosed)};
+        if (max_frame_size_ == 0 || data.size() <= max_frame_size_) {
+            return send_frame_locked(opcode, data, true);
+        }
+        while (!data.empty()) {
+            auto part = data.substr(0, max_frame_size_);
+            data.remove_prefix(part.size());
+            if (auto ret = send_frame_locked(opcode, part, data.empty()); !ret) return ret;
+            opcode = ws::Opcode::CONTINUATION;
+        }
+        return {};
+    }
+
+    //发送单个完整帧（控制帧）
+    auto send(ws::Opcode opcode, std::string_view payload) -> Result<void>{
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (close_sent_) return std::unexpected{make_error(Error::kWebSocketClosed)};
+        return send_frame_locked(opcode, payload, true);
+    }
+
+    auto send_close_locked(ws::CloseCode code, std::string_view reason) -> Result<void>{
+        if (close_sent_) return {};
+        close_sent_ = true;
+        std::string payload;
+        payload += static_cast<char>(static_cast<uint16_t>(code) >> 8);
+        payload += static_cast<char>(static_cast<uint16_t>(code));
+        payload.append(reason.substr(0, 123));
+        return send_frame_locked(ws::Opcode::CLOSE, payload, true);
+    }
+
+    //组装帧头，服务端直接用 writev 发送帧头和负载，避免拷贝负载
+    auto send_frame_locked(ws::Opcode opcode, std::string_view payload, bool fin) -> Result<void>{
+        char header[14];
+        size_t header_size = 2;
+        header[0] = static_cast<char>((fin ? 0x80 : 0) | static_cast<uint8_t>(opcode));
+        uint8_t mask_bit = role_ == Role::CLIENT ? 0x80 : 0;
+        if (payload.size() < 126) {
+            header[1] = static_cast<char>(mask_bit | payload.size());
+        } else if (payload.size() <= 0xffff) {
+            header[1] = static_cast<char>(mask_bit | 126);
+            header[2] = static_cast<char>(payload.size() >> 8);
+            header[3] = static_cast<char>(payload.size());
+            header_size = 4;
+        } else {
+            header[1] = static_cast<char>(mask_bit | 127);
+            for (int i = 0; i < 8; ++i) {
+                header[2 + i] = static_cast<char>(static_cast<uint64_t>(payload.size()) >> (56 - 8 * i));
+            }
+            header_size = 10;
+        }
+
+        std::string masked;
+        if (role_ == Role::CLIENT) {
+            thread_local std::mt19937 rng{std::random_device{}()};
+            uint32_t key = rng();
+            std::array<uint8_t, 4> mask;
+            std::memcpy(mask.data(), &key, 4);
+            std::memcpy(header + header_size, mask.data(), 4);
+            header_size += 4;
+            masked.assign(payload);
+            ws::apply_mask(masked.data(), masked.size(), mask);
+            payload = masked;
+        }
+
+        iovec iov[2] = {{header, header_size}, {const_cast<char*>(payload.data()), payload.size()}};
+        int iov_index = 0;
+        while (iov_index < 2) {
+            auto n = ::writev(stream_.fd(), iov + iov_index, 2 - iov_index);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return std::unexpected{make_error(Error::kWriteFailed)};
+            }
+            //跳过已经完整发送的部分
+            auto written = static_cast<size_t>(n);
+            while (iov_index < 2 && written >= iov[iov_index].iov_len) {
+                written -= iov[iov_index].iov_len;
+                ++iov_index;
+            }
+            if (iov_index < 2) {
+                iov[iov_index].iov_base = static_cast<char*>(iov[iov_index].iov_base) + written;
+                iov[iov_index].iov_len -= written;
+            }
+        }
+        return {};
+    }
+
+    static constexpr size_t kReadBufferSize = 16 * 1024;
+
+    net::TcpStream& stream_;
+    std::string buffer_;          //已读取但尚未解析的数据
+    size_t pos_{0};               //buffer_ 中的读取位置
+    Role role_;
+    size_t max_message_size_{kDefaultMaxMessageSize};
+    size_t max_frame_size_{0};
+    std::mutex send_mutex_;       //保护发送（允许在其它线程推送消息）
+    std::atomic<bool> close_received_{false};
+    std::atomic<bool> close_sent_{false};
+};
+
+}
@@ -0,0 +1,343 @@
+#pragma once
+
+#include "saxio/net/tcp/listener.hpp"
+#include "saxio/net/fd_passing.hpp"
+#include "saxio/common/debug.hpp"
+#include <vector>
+#include <string>
+#include <optional>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+
+namespace saxio::net{
+
+//prefork 模式的 master 进程：持有监听套接字，fork 出 N 个 worker 共享同一个套接字 accept
+//
+//master 响应的信号：
+//  SIGCHLD           worker 退出后重新拉起（启动后 1 秒内退出的 worker 延迟 1 秒再拉起，避免崩溃循环）
+//  SIGHUP            先拉起一组新 worker，再让旧 worker 处理完已有连接后退出
+//  SIGUSR2           二进制升级：重新执行磁盘上的程序，通过 SCM_RIGHTS 把监听套接字交给新一代 master，
+//                    新 master 的 worker 就绪后旧 master 优雅退出；期间监听套接字始终打开，不会拒绝连接
+//  SIGTERM/SIGINT    通知所有 worker 优雅退出，等待它们结束后返回
+//worker 收到 SIGTERM/SIGINT 时调用 on_worker_stop() 注册的回调（通常是 Server::stop）
+class Master {
+public:
+    //worker 的入口函数，返回后 worker 进程退出
+    using WorkerMain = std::function<void(TcpListener&)>;
+
+    explicit Master(uint16_t port, size_t workers = std::thread::hardware_concurrency())
+        : port_(port), worker_count_(workers == 0 ? 1 : workers){}
+
+    //设置 worker 数量
+    auto set_workers(size_t n) -> void{ worker_count_ = n == 0 ? 1 : n; }
+
+    //等待新一代 master 就绪的最长时间，超时视为升级失败，旧 master 继续服务
+    auto set_upgrade_timeout(std::chrono::milliseconds timeout) -> void{ upgrade_timeout_ = timeout; }
+
+    //在 worker 进程中注册收到停止信号时的回调（在单独的线程中调用，不在信号处理函数中）
+    static auto on_worker_stop(std::function<void()> callback) -> void{
+        std::lock_guard<std::mutex> lock(stop_state().mutex);
+        stop_state().callback = std::move(callback);
+    }
+
+    //运行 master：获取监听套接字（继承自旧 master 或重新绑定），拉起 worker 并监督它们
+    //只在 master 中返回（收到停止信号或升级完成后）；必须在创建任何线程之前调用
+    auto run(WorkerMain worker_main) -> Result<void>{
+        worker_main_ = std::move(worker_main);
+
+        //master 同步处理信号，worker 在 fork 后恢复
+        sigset_t signals;
+        sigemptyset(&signals);
+        for (int sig : {SIGCHLD, SIGHUP, SIGUSR2, SIGTERM, SIGINT, SIGQUIT}) sigaddset(&signals, sig);
+        sigprocmask(SIG_BLOCK, &signals, &original_mask_);
+
+        auto has_listener = acquire_listener();
+        if (!has_listener) {
+            sigprocmask(SIG_SETMASK, &original_mask_, nullptr);
+            return std::unexpected{has_listener.error()};
+        }
+        listener_.emplace(std::move(has_listener.value()));
+
+        workers_.assign(worker_count_, Worker{});
+        for (size_t slot = 0; slot < workers_.size(); ++slot) {
+            if (!spawn_worker(slot)) {
+                stop_workers();
+                sigprocmask(SIG_SETMASK, &original_mask_, nullptr);
+                return std::unexpected{make_error(Error::kForkFailed)};
+            }
+        }
+        LOG_INFO("Master {} started {} workers on fd {}", ::getpid(), workers_.size(), listener_->fd());
+
+        //由旧 master 启动时，worker 已经就绪，通知旧 master 退出
+        if (upgrade_sock_ >= 0) {
+            char ready = 'R';
+            (void)::write(upgrade_sock_, &ready, 1);
+            ::close(upgrade_sock_);
+            upgrade_sock_ = -1;
+        }
+
+        while (true) {
+            timespec timeout{1, 0};
+            siginfo_t info{};
+            int sig = sigtimedwait(&signals, &info, &timeout);
+
+            if (sig == SIGCHLD) {
+                reap_workers();
+            } else if (sig == SIGHUP) {
+                LOG_INFO("Master {} restarting workers", ::getpid());
+                reload_workers();
+            } else if (sig == SIGUSR2) {
+                if (upgrade()) break;
+            } else if (sig == SIGTERM || sig == SIGINT || sig == SIGQUIT) {
+                LOG_INFO("Master {} shutting down", ::getpid());
+                break;
+            }
+            respawn_pending();
+        }
+
+        stop_workers();
+        sigprocmask(SIG_SETMASK, &original_mask_, nullptr);
+        return {};
+    }
+
+private:
+    struct Worker {
+        pid_t pid{-1};
+        std::chrono::steady_clock::time_point started_at;
+        std::chrono::steady_clock::time_point respawn_at;   //延迟拉起的时间（pid 为 -1 时有效）
+    };
+
+    struct StopState {
+        std::mutex mutex;
+        std::function<void()> callback;
+    };
+
+    static auto stop_state() -> StopState&{
+        static StopState state;
+        return state;
+    }
+
+    //从环境变量指定的 UNIX 套接字接收旧 master 的监听套接字，没有时重新绑定端口
+    auto acquire_listener() -> Result<TcpListener>{
+        if (const char* inherited = ::getenv(kUpgradeEnv)) {
+            upgrade_sock_ = std::atoi(inherited);
+            ::unsetenv(kUpgradeEnv);
+            ::fcntl(upgrade_sock_, F_SETFD, FD_CLOEXEC);
+
+            auto fds = detail::recv_fds(upgrade_sock_, 1);
+            if (fds.size() != 1) {
+                LOG_ERROR("Receive listener from old master failed");
+                ::close(upgrade_sock_);
+                upgrade_sock_ = -1;
+                return std::unexpected{make_error(Error::kFdPassingFailed)};
+            }
+            LOG_INFO("Master {} inherited listener fd {}", ::getpid(), fds[0]);
+            return TcpListener{detail::Socket{fds[0]}};
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port_);
+        return TcpListener::bind(reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+
+    //fork 一个 worker 放入指定槽位
+    auto spawn_worker(size_t slot) -> bool{
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            LOG_ERROR("Fork worker failed: {}", strerror(errno));
+            workers_[slot].pid = -1;
+            workers_[slot].respawn_at = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            return false;
+        }
+        if (pid == 0) {
+            run_worker();
+        }
+        workers_[slot].pid = pid;
+        workers_[slot].started_at = std::chrono::steady_clock::now();
+        LOG_INFO("Worker {} started in slot {}", pid, slot);
+        return true;
+    }
+
+    //worker 进程：停止信号交给单独的线程同步等待，其余信号恢复默认处理
+    [[noreturn]]
+    auto run_worker() -> void{
+        //master 退出时 worker 随之退出，不会留下孤儿进程继续 accept
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+        sigset_t stop_signals;
+        sigemptyset(&stop_signals);
+        for (int sig : {SIGTERM, SIGINT, SIGQUIT}) sigaddset(&stop_signals, sig);
+        sigset_t mask = original_mask_;
+        for (int sig : {SIGCHLD, SIGHUP, SIGUSR2}) sigdelset(&mask, sig);
+        for (int sig : {SIGTERM, SIGINT, SIGQUIT}) sigaddset(&mask, sig);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+        std::thread([stop_signals] {
+            int sig = 0;
+            sigwait(&stop_signals, &sig);
+            std::function<void()> callback;
+            {
+                std::lock_guard<std::mutex> lock(stop_state().mutex);
+                callback = stop_state().callback;
+            }
+            if (!callback) {
+                ::_exit(0);
+            }
+            callback();
+        }).detach();
+
+        worker_main_(*listener_);
+        std::cout.flush();
+        std::cerr.flush();
+        ::_exit(0);
+    }
+
+    //回收退出的子进程，当前槽位中的 worker 退出时安排重新拉起
+    auto reap_workers() -> void{
+        int status = 0;
+        pid_t pid;
+        while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+            for (auto& worker : workers_) {
+                if (worker.pid != pid) continue;
+
+                if (WIFSIGNALED(status)) {
+                    LOG_WARN("Worker {} killed by signal {}", pid, WTERMSIG(status));
+                } else {
+                    LOG_WARN("Worker {} exited with status {}", pid, WEXITSTATUS(status));
+                }
+                auto now = std::chrono::steady_clock::now();
+                worker.pid = -1;
+                worker.respawn_at = now - worker.started_at < std::chrono::seconds(1)
+                    ? now + std::chrono::seconds(1) : now;
+            }
+        }
+    }
+
+    //拉起到期的空槽位
+    auto respawn_pending() -> void{
+        auto now = std::chrono::steady_clock::now();
+        for (size_t slot = 0; slot < workers_.size(); ++slot) {
+            if (workers_[slot].pid < 0 && workers_[slot].respawn_at <= now) {
+                spawn_worker(slot);
+            }
+        }
+    }
+
+    //滚动重启：新 worker 先开始 accept，旧 worker 再退出
+    auto reload_workers() -> void{
+        std::vector<pid_t> old_pids;
+        for (size_t slot = 0; slot < workers_.size(); ++slot) {
+            if (workers_[slot].pid > 0) old_pids.push_back(workers_[slot].pid);
+            spawn_worker(slot);
+        }
+        for (pid_t pid : old_pids) {
+            ::kill(pid, SIGTERM);
+        }
+        //旧 worker 不在槽位中，退出时由 reap_workers 回收而不会被重新拉起
+    }
+
+    //二进制升级：返回 true 表示新一代 master 已就绪，本进程应当退出
+    auto upgrade() -> bool{
+        auto args = read_cmdline();
+        if (args.empty()) {
+            LOG_ERROR("Upgrade failed: cannot read command line");
+            return false;
+        }
+
+        int sv[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) {
+            LOG_ERROR("Upgrade failed: socketpair: {}", strerror(errno));
+            return false;
+        }
+
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            LOG_ERROR("Upgrade failed: fork: {}", strerror(errno));
+            ::close(sv[0]);
+            ::close(sv[1]);
+            return false;
+        }
+        if (pid == 0) {
+            //新 master：只保留与旧 master 通信的套接字，其余描述符在 exec 时关闭
+            ::fcntl(sv[1], F_SETFD, 0);
+            ::setenv(kUpgradeEnv, std::to_string(sv[1]).c_str(), 1);
+            sigprocmask(SIG_SETMASK, &original_mask_, nullptr);
+
+            std::vector<char*> argv;
+            for (auto& arg : args) argv.push_back(arg.data());
+            argv.push_back(nullptr);
+            ::execvp(argv[0], argv.data());
+            ::_exit(127);
+        }
+
+        ::close(sv[1]);
+        LOG_INFO("Master {} upgrading to new master {}", ::getpid(), pid);
+        bool ready = detail::send_fds(sv[0], {listener_->fd()}) && wait_ready(sv[0]);
+        ::close(sv[0]);
+        if (!ready) {
+            LOG_ERROR("Upgrade failed: new master {} did not become ready", pid);
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+            return false;
+        }
+        LOG_INFO("New master {} is ready, old master {} exiting", pid, ::getpid());
+        return true;
+    }
+
+    auto wait_ready(int sock) const -> bool{
+        pollfd pfd{sock, POLLIN, 0};
+        if (::poll(&pfd, 1, static_cast<int>(upgrade_timeout_.count())) <= 0) return false;
+        char ready = 0;
+        return ::read(sock, &ready, 1) == 1 && ready == 'R';
+    }
+
+    //通知所有 worker 优雅退出并等待它们结束
+    auto stop_workers() -> void{
+        for (auto& worker : workers_) {
+            if (worker.pid > 0) ::kill(worker.pid, SIGTERM);
+        }
+        for (auto& worker : workers_) {
+            if (worker.pid > 0) ::waitpid(worker.pid, nullptr, 0);
+            worker.pid = -1;
+        }
+        //回收滚动重启中遗留的旧 worker
+        while (::waitpid(-1, nullptr, WNOHANG) > 0) {}
+    }
+
+    static auto read_cmdline() -> std::vector<std::string>{
+        std::ifstream file("/proc/self/cmdline", std::ios::binary);
+        std::vector<std::string> args;
+        for (std::string arg; std::getline(file, arg, '\0');) {
+            args.push_back(std::move(arg));
+        }
+        return args;
+    }
+
+    static constexpr const char* kUpgradeEnv = "SAXIO_UPGRADE_FD";  //新 master 接收监听套接字的 fd
+
+    uint16_t port_;                     //监听端口（继承监听套接字时不使用）
+    size_t worker_count_;               //worker 数量
+    std::chrono::milliseconds upgrade_timeout_{std::chrono::seconds(30)};  //等待新 master 就绪的时间
+    WorkerMain worker_main_;            //worker 入口
+    std::optional<TcpListener> listener_;   //共享的监听套接字
+    std::vector<Worker> workers_;       //worker 槽位
+    sigset_t original_mask_{};          //run() 之前的信号屏蔽字
+    int upgrade_sock_{-1};              //与旧 master 通信的套接字
+};
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "saxio/common/error.hpp"
+#include "saxio/net/rpc/protocol.hpp"
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace saxio::rpc{
+
+//批量调用：请求帧带 kFlagBatch 标志，一帧携带同一方法的一组操作数
+//
+//  请求负载：u32 count | count 个 f64 a | count 个 f64 b
+//  响应负载：u32 count | count 个 f64 结果
+//
+//操作数按数组连续存放（而不是 a,b 交替），服务器可以直接在接收缓冲区上做向量运算。
+inline constexpr uint32_t kMaxBatchSize = (kMaxPayloadSize - sizeof(uint32_t)) / (2 * sizeof(double));
+
+//批量处理函数：out[i] = a[i] op b[i]，三个数组为本机字节序且长度必须相同，否则返回错误
+using BatchHandler = Result<void> (*)(std::span<const double> a, std::span<const double> b, std::span<double> out);
+
+//编码批量请求负载
+inline auto append_batch_operands(std::string& out, std::span<const double> a, std::span<const double> b) -> void{
+    PayloadWriter writer{out};
+    writer.write(static_cast<uint32_t>(a.size()));
+    if constexpr (std::endian::native == std::endian::little) {
+        out.append(reinterpret_cast<const char*>(a.data()), a.size_bytes());
+        out.append(reinterpret_cast<const char*>(b.data()), b.size_bytes());
+    } else {
+        for (double v : a) writer.write(v);
+        for (double v : b) writer.write(v);
+    }
+}
+
+//解码批量响应负载，数据不完整时返回 false
+inline auto read_batch_results(std::span<const char> payload, std::vector<double>& results) -> bool{
+    PayloadReader reader{payload};
+    auto count = reader.read<uint32_t>();
+    if (!count || reader.remaining() != count.value() * sizeof(double)) {
+        return false;
+    }
+    results.resize(count.value());
+    for (auto& v : results) v = reader.read<double>().value();
+    return true;
+}
+
+namespace detail {
+
+//按方法生成的逐元素运算，SIMD 分支与标量尾部共用同一个 Op
+template <Method Op>
+inline auto scalar_op(double a, double b) -> double{
+    if constexpr (Op == Method::ADD) return a + b;
+    else if constexpr (Op == Method::SUB) return a - b;
+    else if constexpr (Op == Method::MUL) return a * b;
+    else return a / b;
+}
+
+#if defined(__AVX2__)
+template <Method Op>
+inline auto simd_op(__m256d a, __m256d b) -> __m256d{
+    if constexpr (Op == Method::ADD) return _mm256_add_pd(a, b);
+    else if constexpr (Op == Method::SUB) return _mm256_sub_pd(a, b);
+    else if constexpr (Op == Method::MUL) return _mm256_mul_pd(a, b);
+    else return _mm256_div_pd(a, b);
+}
+#endif
+#if defined(__SSE2__)
+template <Method Op>
+inline auto simd_op(__m128d a, __m128d b) -> __m128d{
+    if constexpr (Op == Method::ADD) return _mm_add_pd(a, b);
+    else if constexpr (Op == Method::SUB) return _mm_sub_pd(a, b);
+    else if constexpr (Op == Method::MUL) return _mm_mul_pd(a, b);
+    else return _mm_div_pd(a, b);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+template <Method Op>
+inline auto simd_op(float64x2_t a, float64x2_t b) -> float64x2_t{
+    if constexpr (Op == Method::ADD) return vaddq_f64(a, b);
+    else if constexpr (Op == Method::SUB) return vsubq_f64(a, b);
+    else if constexpr (Op == Method::MUL) return vmulq_f64(a, b);
+    else return vdivq_f64(a, b);
+}
+#endif
+
+template <Method Op>
+inline auto batch_kernel(const char* a, const char* b, char* out, size_t n) -> void{
+    size_t i = 0;
+    //向量分支直接按本机字节序加载，只在小端平台启用
+    if constexpr (std::endian::native == std::endian::little) {
+#if defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            __m256d va = _mm256_loadu_pd(reinterpret_cast<const double*>(a + i * 8));
+            __m256d vb = _mm256_loadu_pd(reinterpret_cast<const double*>(b + i * 8));
+            _mm256_storeu_pd(reinterpret_cast<double*>(out + i * 8), simd_op<Op>(va, vb));
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 2 <= n; i += 2) {
+            __m128d va = _mm_loadu_pd(reinterpret_cast<const double*>(a + i * 8));
+            __m128d vb = _mm_loadu_pd(reinterpret_cast<const double*>(b + i * 8));
+            _mm_storeu_pd(reinterpret_cast<double*>(out + i * 8), simd_op<Op>(va, vb));
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        for (; i + 2 <= n; i += 2) {
+            float64x2_t va = vreinterpretq_f64_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(a + i * 8)));
+            float64x2_t vb = vreinterpretq_f64_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(b + i * 8)));
+            vst1q_u8(reinterpret_cast<uint8_t*>(out + i * 8), vreinterpretq_u8_f64(simd_op<Op>(va, vb)));
+        }
+#endif
+    }
+    for (; i < n; ++i) {
+        store(out + i * 8, scalar_op<Op>(load<double>(a + i * 8), load<double>(b + i * 8)));
+    }
+}
+
+//校验长度后对本机字节序的数组执行批量运算
+template <Method Op>
+inline auto run_batch(std::span<const double> a, std::span<const double> b, std::span<double> out) -> Result<void>{
+    if (a.size() != b.size() || a.size() != out.size()) {
+        return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
+    }
+    if constexpr (std::endian::native == std::endian::little) {
+        //小端平台上本机字节序与线路格式相同，直接使用向量内核
+        batch_kernel<Op>(reinterpret_cast<const char*>(a.data()), reinterpret_cast<const char*>(b.data()),
+                         reinterpret_cast<char*>(out.data()), out.size());
+    } else {
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = scalar_op<Op>(a[i], b[i]);
+        }
+    }
+    return {};
+}
+
+} // namespace detail
+
+}
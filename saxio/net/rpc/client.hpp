@@ -0,0 +1,487 @@
+#pragma once
+
+#include "saxio/net/rpc/protocol.hpp"
+#include "saxio/net/rpc/registry.hpp"
+#include "saxio/net/rpc/batch.hpp"
+#include "saxio/net/tcp/stream.hpp"
+#include <netinet/tcp.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace saxio::rpc{
+
+//二进制协议 RPC 客户端：一个连接上可以同时有任意多个未完成的调用
+//
+//每个调用带有唯一的请求 ID，后台读线程按请求 ID 把响应交给对应的 future 或回调，
+//服务器可以以任意顺序返回响应。发送采用流水线方式：多个线程同时发起调用时，
+//第一个拿到写权限的线程把其余线程追加的请求合并成一次发送。
+//超时由后台定时线程处理，调用以 kRPCDeadlineExceeded 结束，之后到达的响应直接丢弃；
+//超时同时作为截止时间随请求发给服务器，服务器不会再执行已经过期的调用。
+//连接断开时所有未完成的调用以 kReadFailed 结束。
+class Client {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Client(net::TcpStream stream) : stream_(std::move(stream)){
+        reader_ = std::thread([this] { read_loop(); });
+        timer_ = std::thread([this] { timer_loop(); });
+    }
+
+    Client(const Client&) = delete;
+    auto operator=(const Client&) -> Client& = delete;
+
+    ~Client(){
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            stopping_ = true;
+        }
+        timer_cv_.notify_all();
+        ::shutdown(stream_.fd(), SHUT_RDWR);
+        if (reader_.joinable()) reader_.join();
+        if (timer_.joinable()) timer_.join();
+    }
+
+    //连接服务器
+    static auto connect(const sockaddr_in& addr) -> Result<std::unique_ptr<Client>>{
+        auto stream = net::TcpStream::connect_client(reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        if (!stream) {
+            return std::unexpected{stream.error()};
+        }
+        //小帧流水线发送，关闭 Nagle 避免与延迟确认叠加产生 40ms 停顿
+        int one = 1;
+        ::setsockopt(stream->fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return std::make_unique<Client>(std::move(stream.value()));
+    }
+
+    //未指定超时的调用使用的默认超时（0 表示不超时）
+    auto set_default_timeout(std::chrono::milliseconds timeout) -> void{
+        default_timeout_ms_.store(timeout.count(), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    auto default_timeout() const -> std::chrono::milliseconds{
+        return std::chrono::milliseconds(default_timeout_ms_.load(std::memory_order_relaxed));
+    }
+
+    //发起调用，R 为方法的返回值类型；参数按服务器端方法签名的顺序编码
+    template <typename R, typename... Args>
+    auto call(uint32_t method_id, const Args&... args) -> std::future<Result<R>>{
+        return call_with_timeout<R>(default_timeout(), method_id, args...);
+    }
+
+    template <typename R, typename... Args>
+    auto call(Method method, const Args&... args) -> std::future<Result<R>>{
+        return call<R>(static_cast<uint32_t>(method), args...);
+    }
+
+    //指定超时的调用，超过截止时间后 future 以 kRPCDeadlineExceeded 结束
+    template <typename R, typename... Args>
+    auto call_with_timeout(std::chrono::milliseconds timeout, uint32_t method_id, const Args&... args)
+        -> std::future<Result<R>>{
+        auto promise = std::make_shared<std::promise<Result<R>>>();
+        auto future = promise->get_future();
+        async_call<R>(method_id, timeout, [promise](Result<R> result) {
+            promise->set_value(std::move(result));
+        }, args...);
+        return future;
+    }
+
+    //回调形式的调用：不创建 future，callback(Result<R>) 在客户端的后台线程中执行，应尽快返回
+    //返回请求 ID，可用于 cancel()
+    template <typename R, typename Callback, typename... Args>
+    auto async_call(uint32_t method_id, std::chrono::milliseconds timeout, Callback callback,
+                    const Args&... args) -> uint32_t{
+        uint32_t request_id = next_request_id_.fetch_add(1, std::memory_order_relaxed);
+        std::string frame;
+        begin_request(frame, 0, method_id, request_id, timeout);
+        PayloadWriter writer{frame};
+        (encode_arg(writer, args), ...);
+        patch_payload_size(frame, 0);
+
+        submit(request_id, std::move(frame), timeout, [callback = std::move(callback)](Result<Reply> reply) mutable {
+            callback(decode_response<R>(reply));
+        });
+        return request_id;
+    }
+
+    //取消未完成的调用：本地立即以 kRPCCancelled 结束，并通知服务器不再执行或写回结果
+    auto cancel(uint32_t request_id) -> void{
+        Completion completion;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            completion = take(request_id);
+        }
+        if (!completion) return;
+
+        std::string frame;
+        append_header(frame, {kFlagCancel, 0, request_id, 0});
+        send(std::move(frame));
+        completion(std::unexpected{make_error(Error::kRPCCancelled)});
+    }
+
+    //批量调用内置算术方法：一次往返完成 a.size() 组运算，结果按顺序返回
+    auto call_batch(Method method, std::span<const double> a, std::span<const double> b)
+        -> std::future<Result<std::vector<double>>>{
+        auto promise = std::make_shared<std::promise<Result<std::vector<double>>>>();
+        auto future = promise->get_future();
+        if (a.size() != b.size() || a.size() > kMaxBatchSize) {
+            promise->set_value(std::unexpected{make_error(Error::kRPCParameterParsingFailed)});
+            return future;
+        }
+
+        uint32_t request_id = next_request_id_.fetch_add(1, std::memory_order_relaxed);
+        std::string frame;
+        frame.reserve(kFrameHeaderSize + sizeof(uint32_t) + a.size_bytes() + b.size_bytes());
+        begin_request(frame, kFlagBatch, static_cast<uint32_t>(method), request_id, default_timeout());
+        append_batch_operands(frame, a, b);
+        patch_payload_size(frame, 0);
+
+        submit(request_id, std::move(frame), default_timeout(), [promise](Result<Reply> reply) {
+            if (!reply) {
+                promise->set_value(std::unexpected{reply.error()});
+                return;
+            }
+            std::vector<double> results;
+            if (!read_batch_results(reply->payload, results)) {
+                promise->set_value(std::unexpected{make_error(Error::kRPCParameterParsingFailed)});
+                return;
+            }
+            promise->set_value(std::move(results));
+        });
+        return future;
+    }
+
+    //未完成的调用数
+    [[nodiscard]]
+    auto pending_count() -> size_t{
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        return pending_.size();
+    }
+
+    //连接是否已断开
+    [[nodiscard]]
+    auto is_closed() -> bool{
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        return closed_;
+    }
+
+private:
+    //成功收到的响应帧（错误帧在交给 Completion 之前转换为错误）
+    struct Reply {
+        const FrameHeader& header;
+        std::span<const char> payload;
+    };
+
+    using Completion = std::function<void(Result<Reply>)>;
+
+    struct Pending {
+        Completion completion;
+        std::multimap<Clock::time_point, uint32_t>::iterator deadline;
+        bool has_deadline{false};
+    };
+
+    //追加请求帧头；设置了超时的调用把超时作为截止时间告诉服务器
+    static auto begin_request(std::string& frame, uint16_t flags, uint32_t method_id, uint32_t request_id,
+                              std::chrono::milliseconds timeout) -> void{
+        if (timeout.count() <= 0) {
+            append_header(frame, {flags, method_id, request_id, 0});
+            return;
+        }
+        append_header(frame, {static_cast<uint16_t>(flags | kFlagDeadline), method_id, request_id, 0});
+        auto budget = std::chrono::duration_cast<std::chrono::microseconds>(timeout).count();
+        PayloadWriter(frame).write(static_cast<uint32_t>(std::min<int64_t>(budget, UINT32_MAX)));
+    }
+
+    //登记响应处理函数并把请求帧加入发送队列；连接已关闭时立即以错误结束
+    auto submit(uint32_t request_id, std::string frame, std::chrono::milliseconds timeout,
+                Completion completion) -> void{
+        bool closed;
+        bool earliest = false;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            closed = closed_;
+            if (!closed) {
+                Pending pending;
+                pending.completion = std::move(completion);
+                if (timeout.count() > 0) {
+                    pending.deadline = deadlines_.emplace(Clock::now() + timeout, request_id);
+                    pending.has_deadline = true;
+                    earliest = pending.deadline == deadlines_.begin();
+                }
+                pending_.emplace(request_id, std::move(pending));
+            }
+        }
+        if (closed) {
+            completion(std::unexpected{make_error(Error::kReadFailed)});
+            return;
+        }
+        if (earliest) {
+            timer_cv_.notify_one();
+        }
+        send(std::move(frame));
+    }
+
+    //追加请求并在没有其他线程写入时负责发送；发送失败时关闭连接，由读线程结束所有调用
+    auto send(std::string frame) -> void{
+        std::unique_lock<std::mutex> lock(write_mutex_);
+        out_.append(frame);
+        if (writing_) return;
+
+        writing_ = true;
+        while (!out_.empty()) {
+            std::string batch;
+            batch.swap(out_);
+            lock.unlock();
+            bool ok = send_all(stream_.fd(), batch).has_value();
+            lock.lock();
+            if (!ok) {
+                out_.clear();
+                ::shutdown(stream_.fd(), SHUT_RDWR);
+            }
+        }
+        writing_ = false;
+    }
+
+    template <typename T>
+    static auto encode_arg(PayloadWriter& writer, const T& value) -> void{
+        if constexpr (std::is_convertible_v<const T&, std::string_view> && !std::is_arithmetic_v<T>) {
+            detail::Codec<std::string_view>::encode(writer, value);
+        } else {
+            detail::Codec<T>::encode(writer, value);
+        }
+    }
+
+    template <typename R>
+    static auto decode_response(const Result<Reply>& reply) -> Result<R>{
+        if (!reply) {
+            return std::unexpected{reply.error()};
+        }
+        if constexpr (std::is_void_v<R>) {
+            return {};
+        } else {
+            PayloadReader reader{reply->payload};
+            auto value = detail::Codec<R>::decode(reader);
+            if (!value) {
+                return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
+            }
+            return std::move(value.value());
+        }
+    }
+
+    //取出请求 ID 对应的调用（已超时或已完成时返回空）；调用方需持有 pending_mutex_
+    auto take(uint32_t request_id) -> Completion{
+        auto it = pending_.find(request_id);
+        if (it == pending_.end()) return {};
+        if (it->second.has_deadline) {
+            deadlines_.erase(it->second.deadline);
+        }
+        Completion completion = std::move(it->second.completion);
+        pending_.erase(it);
+        return completion;
+    }
+
+    auto complete(const FrameHeader& header, std::span<const char> payload) -> void{
+        Completion completion;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            completion = take(header.request_id);
+        }
+        if (!completion) return;
+
+        if (header.flags & kFlagError) {
+            auto code = PayloadReader{payload}.read<int32_t>();
+            completion(std::unexpected{make_error(code ? code.value() : Error::kUnknown)});
+        } else {
+            completion(Reply{header, payload});
+        }
+    }
+
+    auto read_loop() -> void{
+        FrameDecoder decoder;
+        while (true) {
+            auto buf = decoder.prepare();
+            auto read_result = stream_.read(buf);
+            if (!read_result || read_result.value() == 0) break;
+            decoder.commit(read_result.value());
+
+            FrameHeader header;
+            std::span<const char> payload;
+            while (decoder.next(header, payload)) {
+                if (header.flags & kFlagResponse) {
+                    complete(header, payload);
+                }
+            }
+            if (decoder.error()) break;
+        }
+
+        //连接断开：结束所有未完成的调用
+        std::unordered_map<uint32_t, Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            closed_ = true;
+            pending.swap(pending_);
+            deadlines_.clear();
+        }
+        for (auto& [id, call] : pending) {
+            call.completion(std::unexpected{make_error(Error::kReadFailed)});
+        }
+    }
+
+    //按截止时间结束超时的调用
+    auto timer_loop() -> void{
+        std::unique_lock<std::mutex> lock(pending_mutex_);
+        while (!stopping_) {
+            if (deadlines_.empty()) {
+                timer_cv_.wait(lock);
+                continue;
+            }
+            auto earliest = deadlines_.begin()->first;
+            if (Clock::now() < earliest) {
+                timer_cv_.wait_until(lock, earliest);
+                continue;
+            }
+
+            std::vector<Completion> expired;
+            auto now = Clock::now();
+            while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+                if (auto completion = take(deadlines_.begin()->second)) {
+                    expired.push_back(std::move(completion));
+                }
+            }
+            lock.unlock();
+            for (auto& completion : expired) {
+                completion(std::unexpected{make_error(Error::kRPCDeadlineExceeded)});
+            }
+            lock.lock();
+        }
+    }
+
+    net::TcpStream stream_;
+    std::thread reader_;
+    std::thread timer_;
+
+    std::mutex write_mutex_;
+    std::string out_;               //等待发送的请求帧
+    bool writing_{false};           //是否有线程正在发送
+
+    std::mutex pending_mutex_;
+    std::condition_variable timer_cv_;
+    std::unordered_map<uint32_t, Pending> pending_;                 //请求 ID -> 未完成的调用
+    std::multimap<Clock::time_point, uint32_t> deadlines_;          //截止时间 -> 请求 ID
+    bool closed_{false};
+    bool stopping_{false};
+
+    std::atomic<uint32_t> next_request_id_{1};
+    std::atomic<int64_t> default_timeout_ms_{0};
+};
+
+//跨服务器的 RPC 连接池：每个服务器保持若干个连接，调用按轮询分配到连接上
+//
+//连接在第一次使用时建立，断开后在下一次分配到它时重连；连接失败的槽位在一段时间内跳过，
+//不会因为某个服务器不可用而拖慢所有调用。
+class ClientPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ClientPool(const std::vector<sockaddr_in>& servers, size_t connections_per_server = 1)
+        : slots_(servers.size() * std::max<size_t>(connections_per_server, 1)){
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            slots_[i].addr = servers[i % servers.size()];
+        }
+    }
+
+    //新建立的连接使用的默认超时
+    auto set_default_timeout(std::chrono::milliseconds timeout) -> void{
+        default_timeout_ = timeout;
+    }
+
+    //连接失败后跳过该槽位的时间
+    auto set_reconnect_interval(std::chrono::milliseconds interval) -> void{
+        reconnect_interval_ = interval;
+    }
+
+    template <typename R, typename... Args>
+    auto call(uint32_t method_id, const Args&... args) -> std::future<Result<R>>{
+        auto client = acquire();
+        if (!client) return failed<R>();
+        return client->template call<R>(method_id, args...);
+    }
+
+    template <typename R, typename... Args>
+    auto call(Method method, const Args&... args) -> std::future<Result<R>>{
+        return call<R>(static_cast<uint32_t>(method), args...);
+    }
+
+    template <typename R, typename... Args>
+    auto call_with_timeout(std::chrono::milliseconds timeout, uint32_t method_id, const Args&... args)
+        -> std::future<Result<R>>{
+        auto client = acquire();
+        if (!client) return failed<R>();
+        return client->template call_with_timeout<R>(timeout, method_id, args...);
+    }
+
+    auto call_batch(Method method, std::span<const double> a, std::span<const double> b)
+        -> std::future<Result<std::vector<double>>>{
+        auto client = acquire();
+        if (!client) return failed<std::vector<double>>();
+        return client->call_batch(method, a, b);
+    }
+
+    //按轮询取一个可用的连接，所有服务器都不可用时返回空
+    auto acquire() -> std::shared_ptr<Client>{
+        if (slots_.empty()) return nullptr;
+        size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t attempt = 0; attempt < slots_.size(); ++attempt) {
+            Slot& slot = slots_[(start + attempt) % slots_.size()];
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            if (slot.client && !slot.client->is_closed()) {
+                return slot.client;
+            }
+            auto now = Clock::now();
+            if (now < slot.retry_at) {
+                continue;
+            }
+            auto client = Client::connect(slot.addr);
+            if (!client) {
+                slot.retry_at = now + reconnect_interval_;
+                continue;
+            }
+            client.value()->set_default_timeout(default_timeout_);
+            slot.client = std::move(client.value());
+            return slot.client;
+        }
+        return nullptr;
+    }
+
+private:
+    struct Slot {
+        sockaddr_in addr{};
+        std::mutex mutex;
+        std::shared_ptr<Client> client;
+        Clock::time_point retry_at{};     //连接失败后在此之前不再尝试
+    };
+
+    template <typename R>
+    static auto failed() -> std::future<Result<R>>{
+        std::promise<Result<R>> promise;
+        promise.set_value(std::unexpected{make_error(Error::kClientConnectFailed)});
+        return promise.get_future();
+    }
+
+    std::vector<Slot> slots_;
+    std::atomic<size_t> next_{0};
+    std::chrono::milliseconds default_timeout_{0};
+    std::chrono::milliseconds reconnect_interval_{1000};
+};
+
+}
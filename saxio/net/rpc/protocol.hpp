@@ -0,0 +1,264 @@
+#pragma once
+
+#include "saxio/common/error.hpp"
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <optional>
+#include <cerrno>
+#include <sys/socket.h>
+
+namespace saxio::rpc{
+
+//二进制 RPC 帧格式（所有整数均为小端序）：
+//
+//  0      1        2        4            8             12            16
+//  +------+--------+--------+------------+-------------+-------------+----------
+//  | 魔数 | 版本   | 标志   | 方法 ID    | 请求 ID     | 负载长度    | 负载 ...
+//  +------+--------+--------+------------+-------------+-------------+----------
+//
+//请求负载为依次编码的参数，响应负载为返回值（ERROR 标志时为 4 字节错误码）。
+//文本协议（"add 1 2\n"）的首字节是字母，与魔数不会冲突，服务器按连接的首字节区分两种模式。
+
+inline constexpr uint8_t kFrameMagic = 0xB5;
+inline constexpr uint8_t kFrameVersion = 1;
+inline constexpr size_t kFrameHeaderSize = 16;
+inline constexpr uint32_t kMaxPayloadSize = 16 * 1024 * 1024;   //单帧负载上限
+
+//帧标志位
+inline constexpr uint16_t kFlagResponse = 1 << 0;   //响应帧
+inline constexpr uint16_t kFlagError = 1 << 1;      //错误响应，负载为错误码
+inline constexpr uint16_t kFlagBatch = 1 << 2;      //批量调用，负载格式见 batch.hpp
+inline constexpr uint16_t kFlagDeadline = 1 << 3;   //负载以 u32 剩余时间（微秒）开头
+inline constexpr uint16_t kFlagCancel = 1 << 4;     //取消帧：取消同一连接上 request_id 对应的调用，没有负载
+
+//内置方法 ID（0 保留）
+enum class Method : uint32_t {
+    ADD = 1,
+    SUB = 2,
+    MUL = 3,
+    DIV = 4,
+};
+
+struct FrameHeader {
+    uint16_t flags{0};
+    uint32_t method_id{0};
+    uint32_t request_id{0};
+    uint32_t payload_size{0};
+};
+
+namespace detail {
+
+template <typename T>
+inline auto to_little(T value) -> T{
+    if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+        return std::byteswap(value);
+    } else {
+        return value;
+    }
+}
+
+//从任意对齐的位置读取小端数值（memcpy 会被编译为一次普通的 load）
+template <typename T>
+inline auto load(const char* p) -> T{
+    if constexpr (std::is_floating_point_v<T>) {
+        using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+        return std::bit_cast<T>(load<Bits>(p));
+    } else {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return to_little(value);
+    }
+}
+
+template <typename T>
+inline auto store(char* p, T value) -> void{
+    if constexpr (std::is_floating_point_v<T>) {
+        using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+        store(p, std::bit_cast<Bits>(value));
+    } else {
+        value = to_little(value);
+        std::memcpy(p, &value, sizeof(T));
+    }
+}
+
+} // namespace detail
+
+//追加帧头，负载随后由调用方追加
+inline auto append_header(std::string& out, const FrameHeader& header) -> void{
+    char buf[kFrameHeaderSize];
+    buf[0] = static_cast<char>(kFrameMagic);
+    buf[1] = static_cast<char>(kFrameVersion);
+    detail::store(buf + 2, header.flags);
+    detail::store(buf + 4, header.method_id);
+    detail::store(buf + 8, header.request_id);
+    detail::store(buf + 12, header.payload_size);
+    out.append(buf, sizeof(buf));
+}
+
+//解析帧头，魔数、版本或长度非法时返回 std::nullopt
+inline auto parse_header(std::span<const char> data) -> std::optional<FrameHeader>{
+    if (data.size() < kFrameHeaderSize
+        || static_cast<uint8_t>(data[0]) != kFrameMagic
+        || static_cast<uint8_t>(data[1]) != kFrameVersion) {
+        return std::nullopt;
+    }
+    FrameHeader header;
+    header.flags = detail::load<uint16_t>(data.data() + 2);
+    header.method_id = detail::load<uint32_t>(data.data() + 4);
+    header.request_id = detail::load<uint32_t>(data.data() + 8);
+    header.payload_size = detail::load<uint32_t>(data.data() + 12);
+    if (header.payload_size > kMaxPayloadSize) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+//负载读取器：直接从接收缓冲区中按顺序解码参数，不拷贝负载
+class PayloadReader {
+public:
+    explicit PayloadReader(std::span<const char> payload) : data_(payload){}
+
+    //读取一个定长数值，数据不足时返回 std::nullopt
+    template <typename T>
+    auto read() -> std::optional<T>{
+        if (data_.size() < sizeof(T)) return std::nullopt;
+        T value = detail::load<T>(data_.data());
+        data_ = data_.subspan(sizeof(T));
+        return value;
+    }
+
+    //读取一个长度前缀（u32）的字符串，返回指向接收缓冲区的视图
+    auto read_string() -> std::optional<std::string_view>{
+        auto size = read<uint32_t>();
+        if (!size || data_.size() < size.value()) return std::nullopt;
+        std::string_view value{data_.data(), size.value()};
+        data_ = data_.subspan(size.value());
+        return value;
+    }
+
+    //剩余未读取的字节数
+    [[nodiscard]]
+    auto remaining() const -> size_t{ return data_.size(); }
+
+private:
+    std::span<const char> data_;
+};
+
+//截止时间以剩余时间（而不是绝对时间）传递，不依赖两端时钟同步；
+//服务器以收到帧的时刻加上剩余时间作为本地截止时间
+inline auto split_deadline(const FrameHeader& header, std::span<const char>& payload)
+    -> std::optional<std::chrono::microseconds>{
+    if (!(header.flags & kFlagDeadline) || payload.size() < sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+    auto budget = std::chrono::microseconds(detail::load<uint32_t>(payload.data()));
+    payload = payload.subspan(sizeof(uint32_t));
+    return budget;
+}
+
+//负载写入器：追加到输出缓冲区
+class PayloadWriter {
+public:
+    explicit PayloadWriter(std::string& out) : out_(out){}
+
+    template <typename T>
+    auto write(T value) -> void{
+        char buf[sizeof(T)];
+        detail::store(buf, value);
+        out_.append(buf, sizeof(T));
+    }
+
+    auto write_string(std::string_view value) -> void{
+        write(static_cast<uint32_t>(value.size()));
+        out_.append(value);
+    }
+
+private:
+    std::string& out_;
+};
+
+//回填帧头中的负载长度（先追加帧头再写负载时使用）
+inline auto patch_payload_size(std::string& out, size_t header_pos) -> void{
+    auto size = static_cast<uint32_t>(out.size() - header_pos - kFrameHeaderSize);
+    detail::store(out.data() + header_pos + 12, size);
+}
+
+//追加一个错误响应帧
+inline auto append_error(std::string& out, const FrameHeader& request, int error_code) -> void{
+    append_header(out, {static_cast<uint16_t>(kFlagResponse | kFlagError),
+                        request.method_id, request.request_id, sizeof(int32_t)});
+    PayloadWriter(out).write(static_cast<int32_t>(error_code));
+}
+
+//把已编码的帧完整发送到连接（MSG_NOSIGNAL：对端关闭时返回错误而不是产生 SIGPIPE）
+inline auto send_all(int fd, std::string_view data) -> Result<void>{
+    while (!data.empty()) {
+        auto ret = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return std::unexpected{make_error(Error::kWriteFailed)};
+        }
+        data.remove_prefix(ret);
+    }
+    return {};
+}
+
+//从连接中读取的字节流里切分完整的帧；帧的负载视图在下一次 prepare() 之前有效
+class FrameDecoder {
+public:
+    //可以写入新数据的缓冲区（至少 min_size 字节）
+    auto prepare(size_t min_size = 4096) -> std::span<char>{
+        compact();
+        if (buffer_.size() - end_ < min_size) {
+            buffer_.resize(end_ + min_size);
+        }
+        return {buffer_.data() + end_, buffer_.size() - end_};
+    }
+
+    //提交写入 prepare() 缓冲区的字节数
+    auto commit(size_t n) -> void{ end_ += n; }
+
+    //取出下一帧：数据不完整时返回 false；格式错误时同样返回 false 并设置 error()
+    auto next(FrameHeader& header, std::span<const char>& payload) -> bool{
+        std::span<const char> data{buffer_.data() + begin_, end_ - begin_};
+        if (data.size() < kFrameHeaderSize) return false;
+
+        auto parsed = parse_header(data);
+        if (!parsed) {
+            error_ = true;
+            return false;
+        }
+        if (data.size() < kFrameHeaderSize + parsed->payload_size) return false;
+
+        header = parsed.value();
+        payload = data.subspan(kFrameHeaderSize, header.payload_size);
+        begin_ += kFrameHeaderSize + header.payload_size;
+        return true;
+    }
+
+    //是否收到了非法帧（连接应当关闭）
+    [[nodiscard]]
+    auto error() const -> bool{ return error_; }
+
+private:
+    //把未处理的数据移到缓冲区开头
+    auto compact() -> void{
+        if (begin_ == 0) return;
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+
+    std::string buffer_;
+    size_t begin_{0};
+    size_t end_{0};
+    bool error_{false};
+};
+
+}
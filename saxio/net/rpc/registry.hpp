@@ -0,0 +1,428 @@
+#pragma once
+
+#include "saxio/common/error.hpp"
+#include "saxio/net/rpc/protocol.hpp"
+#include "saxio/net/rpc/batch.hpp"
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace saxio::rpc{
+
+//方法调用上下文：方法的参数中声明 const CallContext& 时由服务器传入，不占用负载
+//
+//长时间运行的方法应定期检查 is_cancelled()，客户端取消调用或截止时间已过时尽早返回。
+class CallContext {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CallContext() = default;
+    CallContext(Clock::time_point deadline, const std::atomic<bool>* cancelled)
+        : deadline_(deadline), cancelled_(cancelled){}
+
+    //调用方是否设置了截止时间
+    [[nodiscard]]
+    auto has_deadline() const -> bool{ return deadline_ != Clock::time_point::max(); }
+
+    [[nodiscard]]
+    auto deadline() const -> Clock::time_point{ return deadline_; }
+
+    //距离截止时间的剩余时间（没有截止时间时为最大值）
+    [[nodiscard]]
+    auto remaining() const -> Clock::duration{
+        return has_deadline() ? deadline_ - Clock::now() : Clock::duration::max();
+    }
+
+    //调用已被取消或已超过截止时间
+    [[nodiscard]]
+    auto is_cancelled() const -> bool{
+        if (cancelled_ != nullptr && cancelled_->load(std::memory_order_relaxed)) return true;
+        return has_deadline() && Clock::now() >= deadline_;
+    }
+
+private:
+    Clock::time_point deadline_{Clock::time_point::max()};
+    const std::atomic<bool>* cancelled_{nullptr};
+};
+
+namespace detail {
+
+//推导可调用对象的返回值和参数类型（函数指针、lambda、函数对象）
+template <typename F>
+struct function_traits : function_traits<decltype(&F::operator())> {};
+
+template <typename R, typename... Args>
+struct function_traits<R (*)(Args...)> {
+    using return_type = R;
+    using args_tuple = std::tuple<std::decay_t<Args>...>;
+};
+
+template <typename R, typename... Args>
+struct function_traits<R (*)(Args...) noexcept> : function_traits<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct function_traits<R (C::*)(Args...) const> : function_traits<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct function_traits<R (C::*)(Args...)> : function_traits<R (*)(Args...)> {};
+
+template <typename C, typename R, typename... Args>
+struct function_traits<R (C::*)(Args...) const noexcept> : function_traits<R (*)(Args...)> {};
+
+//返回 Result<T> 的方法可以直接把错误码传给调用方
+template <typename T>
+struct is_result : std::false_type {};
+
+template <typename T>
+struct is_result<Result<T>> : std::true_type {};
+
+//单个参数/返回值的编解码：二进制负载与文本参数两种形式
+template <typename T>
+struct Codec;
+
+template <typename T>
+    requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+struct Codec<T> {
+    static auto decode(PayloadReader& reader) -> std::optional<T>{ return reader.read<T>(); }
+    static auto encode(PayloadWriter& writer, T value) -> void{ writer.write(value); }
+
+    static auto parse(std::string_view text) -> std::optional<T>{
+        T value{};
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc{} || ptr != text.data() + text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+};
+
+template <>
+struct Codec<bool> {
+    static auto decode(PayloadReader& reader) -> std::optional<bool>{
+        auto value = reader.read<uint8_t>();
+        if (!value) return std::nullopt;
+        return value.value() != 0;
+    }
+    static auto encode(PayloadWriter& writer, bool value) -> void{ writer.write<uint8_t>(value ? 1 : 0); }
+
+    static auto parse(std::string_view text) -> std::optional<bool>{
+        if (text == "true" || text == "1") return true;
+        if (text == "false" || text == "0") return false;
+        return std::nullopt;
+    }
+};
+
+//字符串参数直接指向接收缓冲区，仅在方法调用期间有效
+template <>
+struct Codec<std::string_view> {
+    static auto decode(PayloadReader& reader) -> std::optional<std::string_view>{ return reader.read_string(); }
+    static auto encode(PayloadWriter& writer, std::string_view value) -> void{ writer.write_string(value); }
+    static auto parse(std::string_view text) -> std::optional<std::string_view>{ return text; }
+};
+
+template <>
+struct Codec<std::string> {
+    static auto decode(PayloadReader& reader) -> std::optional<std::string>{
+        auto value = reader.read_string();
+        if (!value) return std::nullopt;
+        return std::string(value.value());
+    }
+    static auto encode(PayloadWriter& writer, const std::string& value) -> void{ writer.write_string(value); }
+    static auto parse(std::string_view text) -> std::optional<std::string>{ return std::string(text); }
+};
+
+//取一个方法参数：CallContext 由服务器传入，其余参数从负载中解码
+template <typename T>
+inline auto decode_arg(PayloadReader& reader, const CallContext& context) -> std::optional<T>{
+    if constexpr (std::is_same_v<T, CallContext>) {
+        return context;
+    } else {
+        return Codec<T>::decode(reader);
+    }
+}
+
+//每个参数在文本参数列表中的下标（CallContext 不占位置）以及文本参数个数
+template <typename... Args>
+inline constexpr auto wire_indices() -> std::array<size_t, sizeof...(Args) + 1>{
+    std::array<size_t, sizeof...(Args) + 1> indices{};
+    size_t i = 0, n = 0;
+    ((indices[i++] = n, n += std::is_same_v<Args, CallContext> ? 0 : 1), ...);
+    indices[sizeof...(Args)] = n;
+    return indices;
+}
+
+template <typename T>
+inline auto parse_arg(std::span<const std::string_view> text, size_t index) -> std::optional<T>{
+    if constexpr (std::is_same_v<T, CallContext>) {
+        return CallContext{};
+    } else {
+        return Codec<T>::parse(text[index]);
+    }
+}
+
+//调用方法并把结果交给 on_value，返回值为 void 时 on_value 不会被调用
+template <typename R, typename F, typename Tuple, typename OnValue>
+inline auto invoke_with(F& fn, Tuple&& args, OnValue&& on_value) -> Result<void>{
+    if constexpr (std::is_void_v<R>) {
+        std::apply(fn, std::forward<Tuple>(args));
+        return {};
+    } else if constexpr (is_result<R>::value) {
+        auto result = std::apply(fn, std::forward<Tuple>(args));
+        if (!result) return std::unexpected{result.error()};
+        if constexpr (!std::is_void_v<typename R::value_type>) {
+            on_value(result.value());
+        }
+        return {};
+    } else {
+        on_value(std::apply(fn, std::forward<Tuple>(args)));
+        return {};
+    }
+}
+
+//方法返回的值类型（去掉 Result 包装）
+template <typename R>
+struct value_type_of { using type = R; };
+
+template <typename T>
+struct value_type_of<Result<T>> { using type = T; };
+
+} // namespace detail
+
+//RPC 方法注册表
+//
+//register_method("add", &handle_add) 在编译期根据函数签名生成参数解码和结果编码代码，
+//每个方法分配一个稠密的方法 ID，二进制帧按 ID 直接索引数组分发，调用路径上没有字符串比较。
+//方法名只用于文本协议和客户端查询 ID。注册应在服务器开始处理请求之前完成。
+//方法可以在任意位置声明一个 const CallContext& 参数来获取截止时间和取消状态。
+class Registry {
+public:
+    //注册方法，自动分配下一个空闲的方法 ID 并返回
+    template <typename F>
+    auto register_method(std::string name, F fn) -> uint32_t{
+        uint32_t id = static_cast<uint32_t>(std::max<size_t>(methods_.size(), 1));
+        register_method(id, std::move(name), std::move(fn));
+        return id;
+    }
+
+    //以固定的方法 ID 注册方法（协议中需要稳定 ID 的内置方法），已存在的同 ID 方法会被替换
+    template <typename F>
+    auto register_method(uint32_t id, std::string name, F fn) -> void{
+        using traits = detail::function_traits<F>;
+        using R = typename traits::return_type;
+        using Args = typename traits::args_tuple;
+
+        if (methods_.size() <= id) {
+            methods_.resize(id + 1);
+        }
+        Entry& method = methods_[id];
+        if (!method.name.empty()) {
+            names_.erase(method.name);
+        }
+        method.name = name;
+        method.binary = make_binary_invoker<R>(fn, static_cast<Args*>(nullptr));
+        method.text = make_text_invoker<R>(std::move(fn), static_cast<Args*>(nullptr));
+        names_[std::move(name)] = id;
+    }
+
+    //为方法 ID 注册批量处理函数，处理带 kFlagBatch 的请求帧；数据对齐时直接在接收缓冲区上计算
+    auto register_batch_method(uint32_t id, BatchHandler handler) -> void{
+        if (methods_.size() <= id) {
+            methods_.resize(id + 1);
+        }
+        methods_[id].batch = handler;
+    }
+
+    //方法名对应的 ID，未注册时返回 0
+    [[nodiscard]]
+    auto id_of(std::string_view name) const -> uint32_t{
+        auto it = names_.find(std::string(name));
+        return it == names_.end() ? 0 : it->second;
+    }
+
+    //方法 ID 对应的方法名，未注册时返回空
+    [[nodiscard]]
+    auto name_of(uint32_t id) const -> std::string_view{
+        return contains(id) ? std::string_view(methods_[id].name) : std::string_view{};
+    }
+
+    [[nodiscard]]
+    auto contains(uint32_t id) const -> bool{
+        return id < methods_.size() && methods_[id].binary;
+    }
+
+    //处理一个二进制请求帧，响应帧（或错误帧）追加到 out
+    //payload 不含截止时间前缀（见 split_deadline），截止时间和取消状态通过 context 传给方法
+    auto dispatch(const FrameHeader& header, std::span<const char> payload, std::string& out,
+                  const CallContext& context = {}) const -> void{
+        if (header.flags & kFlagBatch) {
+            dispatch_batch(header, payload, out);
+            return;
+        }
+        if (!contains(header.method_id)) {
+            append_error(out, header, Error::kRPCFindFunctionFailed);
+            return;
+        }
+
+        size_t header_pos = out.size();
+        append_header(out, {kFlagResponse, header.method_id, header.request_id, 0});
+        PayloadReader reader{payload};
+        PayloadWriter writer{out};
+        if (auto result = methods_[header.method_id].binary(reader, writer, context); !result) {
+            out.resize(header_pos);
+            append_error(out, header, result.error().value());
+            return;
+        }
+        patch_payload_size(out, header_pos);
+    }
+
+    //处理一个文本请求："add 1.5 2"，参数以空格分隔，返回格式化后的结果
+    auto dispatch_text(std::string_view request) const -> Result<std::string>{
+        static constexpr size_t kMaxTextArgs = 16;
+        std::string_view args[kMaxTextArgs];
+        size_t count = 0;
+
+        size_t name_end = request.find(' ');
+        std::string_view name = request.substr(0, name_end);
+        if (name_end != std::string_view::npos) {
+            size_t start = name_end + 1;
+            while (start <= request.size()) {
+                if (count == kMaxTextArgs) {
+                    return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
+                }
+                size_t end = request.find(' ', start);
+                if (end == std::string_view::npos) end = request.size();
+                args[count++] = request.substr(start, end - start);
+                start = end + 1;
+            }
+        }
+
+        uint32_t id = id_of(name);
+        if (id == 0) {
+            return std::unexpected{make_error(Error::kRPCFindFunctionFailed)};
+        }
+        return methods_[id].text(std::span<const std::string_view>(args, count));
+    }
+
+private:
+    //批量请求：校验长度后把结果直接写到输出缓冲区中响应帧的位置
+    auto dispatch_batch(const FrameHeader& header, std::span<const char> payload, std::string& out) const -> void{
+        if (header.method_id >= methods_.size() || methods_[header.method_id].batch == nullptr) {
+            append_error(out, header, Error::kRPCFindFunctionFailed);
+            return;
+        }
+        PayloadReader reader{payload};
+        auto count = reader.read<uint32_t>();
+        if (!count || reader.remaining() != static_cast<size_t>(count.value()) * 2 * sizeof(double)) {
+            append_error(out, header, Error::kRPCParameterParsingFailed);
+            return;
+        }
+
+        size_t n = count.value();
+        uint32_t result_size = static_cast<uint32_t>(sizeof(uint32_t) + n * sizeof(double));
+        size_t header_pos = out.size();
+        append_header(out, {static_cast<uint16_t>(kFlagResponse | kFlagBatch), header.method_id,
+                            header.request_id, result_size});
+        PayloadWriter(out).write(count.value());
+        size_t result_pos = out.size();
+        out.resize(result_pos + n * sizeof(double));
+
+        const char* a = payload.data() + sizeof(uint32_t);
+        const char* b = a + n * sizeof(double);
+        char* results = out.data() + result_pos;
+        BatchHandler handler = methods_[header.method_id].batch;
+        Result<void> ret;
+        if (in_place(a) && in_place(b) && in_place(results)) {
+            ret = handler({reinterpret_cast<const double*>(a), n}, {reinterpret_cast<const double*>(b), n},
+                          {reinterpret_cast<double*>(results), n});
+        } else {
+            //未对齐或大端平台：按线路格式解码到临时数组，计算后再编码
+            thread_local std::vector<double> scratch;
+            scratch.resize(3 * n);
+            for (size_t i = 0; i < n; ++i) {
+                scratch[i] = detail::load<double>(a + i * sizeof(double));
+                scratch[n + i] = detail::load<double>(b + i * sizeof(double));
+            }
+            ret = handler({scratch.data(), n}, {scratch.data() + n, n}, {scratch.data() + 2 * n, n});
+            for (size_t i = 0; ret && i < n; ++i) {
+                detail::store(results + i * sizeof(double), scratch[2 * n + i]);
+            }
+        }
+        if (!ret) {
+            out.resize(header_pos);
+            append_error(out, header, ret.error().value());
+        }
+    }
+
+    //线路格式的 f64 数组能否直接当作本机 double 数组使用
+    static auto in_place(const char* p) -> bool{
+        return std::endian::native == std::endian::little
+            && reinterpret_cast<uintptr_t>(p) % alignof(double) == 0;
+    }
+
+    using BinaryInvoker = std::function<Result<void>(PayloadReader&, PayloadWriter&, const CallContext&)>;
+    using TextInvoker = std::function<Result<std::string>(std::span<const std::string_view>)>;
+
+    struct Entry {
+        std::string name;
+        BinaryInvoker binary;
+        TextInvoker text;
+        BatchHandler batch{nullptr};
+    };
+
+    //按参数顺序从负载中解码（花括号初始化保证从左到右求值），全部成功且负载恰好读完才调用
+    template <typename R, typename F, typename... Args>
+    static auto make_binary_invoker(F fn, std::tuple<Args...>*) -> BinaryInvoker{
+        return [fn](PayloadReader& reader, PayloadWriter& writer, const CallContext& context) mutable -> Result<void>{
+            std::tuple<std::optional<Args>...> decoded{detail::decode_arg<Args>(reader, context)...};
+            bool complete = std::apply([](const auto&... arg) { return (arg.has_value() && ...); }, decoded);
+            if (!complete || reader.remaining() != 0) {
+                return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
+            }
+            return detail::invoke_with<R>(fn,
+                std::apply([](auto&... arg) { return std::forward_as_tuple(std::move(*arg)...); }, decoded),
+                [&](const auto& value) {
+                    detail::Codec<std::decay_t<typename detail::value_type_of<R>::type>>::encode(writer, value);
+                });
+        };
+    }
+
+    template <typename R, typename F, typename... Args>
+    static auto make_text_invoker(F fn, std::tuple<Args...>*) -> TextInvoker{
+        return [fn](std::span<const std::string_view> text) mutable -> Result<std::string>{
+            static constexpr auto indices = detail::wire_indices<Args...>();
+            if (text.size() != indices[sizeof...(Args)]) {
+                return std::unexpected{make_error(Error::kRPCOutOfData)};
+            }
+            auto decoded = [&]<size_t... I>(std::index_sequence<I...>) {
+                return std::tuple<std::optional<Args>...>{detail::parse_arg<Args>(text, indices[I])...};
+            }(std::index_sequence_for<Args...>{});
+            bool complete = std::apply([](const auto&... arg) { return (arg.has_value() && ...); }, decoded);
+            if (!complete) {
+                return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
+            }
+
+            std::string response;
+            auto result = detail::invoke_with<R>(fn,
+                std::apply([](auto&... arg) { return std::forward_as_tuple(std::move(*arg)...); }, decoded),
+                [&](const auto& value) { response = std::format("{}", value); });
+            if (!result) return std::unexpected{result.error()};
+            return response;
+        };
+    }
+
+    std::vector<Entry> methods_;                            //方法 ID -> 方法（0 保留）
+    std::unordered_map<std::string, uint32_t> names_;       //方法名 -> 方法 ID
+};
+
+}
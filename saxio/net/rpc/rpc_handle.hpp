@@ -1,7 +1,10 @@
 #pragma once
 
 #include "saxio/common/error.hpp"
-#include <vector>
+#include "saxio/net/rpc/protocol.hpp"
+#include "saxio/net/rpc/registry.hpp"
+#include <string>
+#include <string_view>
 
 namespace saxio::rpc{
 
@@ -11,49 +14,50 @@ inline auto handle_sub(double a, double b) -> double{ return a - b; }
 inline auto handle_mul(double a, double b) -> double{ return a * b; }
 inline auto handle_div(double a, double b) -> double{ return a / b; }
 
-//RPC调用分发器
-inline auto dispatch_rpc_call(std::string_view request) -> Result<int>{
-    std::vector<std::string_view> parts;
-    size_t start = 0;
-
-    //分割字符串为3部分：[函数名，参数a，参数b]
-    while (start < request.size()) {
-        size_t end = request.find(' ', start);
-        if (end == std::string_view::npos) {
-            parts.push_back(request.substr(start));
-            break;
-        }
-        //截取从start到end的子串并存入parts
-        parts.push_back(request.substr(start, end-start));
-        //更新start为下一个分割的起始位置
-        start = end + 1;
-    }
-    //如果分割后不是3个部分直接返回错误
-    if (parts.size() != 3) {
-        return std::unexpected{make_error(Error::kRPCOutOfData)};
-    }
+//批量版本：out[i] = a[i] op b[i]，使用 SIMD 指令（AVX2/SSE2/NEON）逐组计算；三个数组长度不同时返回错误
+inline auto handle_add_batch(std::span<const double> a, std::span<const double> b, std::span<double> out) -> Result<void>{
+    return detail::run_batch<Method::ADD>(a, b, out);
+}
+inline auto handle_sub_batch(std::span<const double> a, std::span<const double> b, std::span<double> out) -> Result<void>{
+    return detail::run_batch<Method::SUB>(a, b, out);
+}
+inline auto handle_mul_batch(std::span<const double> a, std::span<const double> b, std::span<double> out) -> Result<void>{
+    return detail::run_batch<Method::MUL>(a, b, out);
+}
+inline auto handle_div_batch(std::span<const double> a, std::span<const double> b, std::span<double> out) -> Result<void>{
+    return detail::run_batch<Method::DIV>(a, b, out);
+}
 
-    try {
-        int a = std::stoi(std::string(parts[1]));
-        int b = std::stoi(std::string(parts[2]));
-
-        if (parts[0] == "add") {
-            return handle_add(a, b);
-        }else if (parts[0] == "sub") {
-            return handle_sub(a, b);
-        }else if (parts[0] == "mul") {
-            return handle_mul(a, b);
-        }else if (parts[0] == "div") {
-            return handle_div(a, b);
-        }
-
-    }catch (const std::exception& e) {
-        //参数转换（解析）失败
-        return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
-    }
+//内置方法注册表：add/sub/mul/div 使用 protocol.hpp 中固定的方法 ID
+inline auto default_registry() -> Registry&{
+    static Registry registry = [] {
+        Registry r;
+        r.register_method(static_cast<uint32_t>(Method::ADD), "add", &handle_add);
+        r.register_method(static_cast<uint32_t>(Method::SUB), "sub", &handle_sub);
+        r.register_method(static_cast<uint32_t>(Method::MUL), "mul", &handle_mul);
+        r.register_method(static_cast<uint32_t>(Method::DIV), "div", &handle_div);
+        r.register_batch_method(static_cast<uint32_t>(Method::ADD), &handle_add_batch);
+        r.register_batch_method(static_cast<uint32_t>(Method::SUB), &handle_sub_batch);
+        r.register_batch_method(static_cast<uint32_t>(Method::MUL), &handle_mul_batch);
+        r.register_batch_method(static_cast<uint32_t>(Method::DIV), &handle_div_batch);
+        return r;
+    }();
+    return registry;
+}
+
+//文本协议调用分发器（调试用）："add 1.5 2"
+inline auto dispatch_rpc_call(std::string_view request) -> Result<std::string>{
+    return default_registry().dispatch_text(request);
+}
 
-    //未定义的函数调用
-    return std::unexpected{make_error(Error::kRPCFindFunctionFailed)};
+//二进制协议调用分发器：参数直接从接收缓冲区解码，响应帧追加到 out
+inline auto dispatch_rpc_frame(const FrameHeader& header, std::span<const char> payload,
+                               std::string& out) -> void{
+    CallContext context;
+    if (auto budget = split_deadline(header, payload)) {
+        context = CallContext{CallContext::Clock::now() + budget.value(), nullptr};
+    }
+    default_registry().dispatch(header, payload, out, context);
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "saxio/net/rpc/protocol.hpp"
+#include "saxio/net/rpc/registry.hpp"
+#include "saxio/net/tcp/stream.hpp"
+#include "saxio/common/thread_pool.hpp"
+#include "saxio/common/affinity.hpp"
+#include <netinet/tcp.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <condition_variable>
+#include <string>
+
+namespace saxio::rpc{
+
+//服务器调用统计，可由多个连接共享
+struct ServerStats {
+    std::atomic<uint64_t> completed{0};   //执行完成并写回响应的调用
+    std::atomic<uint64_t> expired{0};     //超过截止时间、以错误响应结束的调用
+    std::atomic<uint64_t> cancelled{0};   //被客户端取消的调用
+};
+
+//一个二进制协议连接的请求多路复用
+//
+//读线程只负责切帧，每个请求按请求 ID 交给线程池执行，哪个先完成就先写回哪个响应，
+//慢方法不会阻塞同一连接上后续的调用。多个工作线程同时完成时，由第一个拿到写权限的线程
+//把其余线程追加的响应合并成一次发送。线程池队列已满时请求在读线程上直接执行，形成背压。
+//
+//带截止时间的调用在排队期间过期时不再执行，执行完才过期的不再写回响应（客户端已经放弃），
+//取消帧会标记对应的调用，方法可以通过 CallContext::is_cancelled() 提前结束。
+//
+//线程池绑定了 CPU 时，调用优先交给与连接收包 CPU（SO_INCOMING_CPU）最近的工作线程，连接状态留在同一缓存上。
+class Session {
+public:
+    Session(net::TcpStream& stream, const Registry& registry, net::ThreadPool& pool, ServerStats& stats)
+        : stream_(stream), registry_(registry), pool_(pool), stats_(stats){
+        //响应按完成顺序逐个写回，关闭 Nagle 避免小帧被延迟
+        int one = 1;
+        ::setsockopt(stream_.fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (pool_.pinned()) {
+            if (int cpu = net::incoming_cpu(stream_.fd()); cpu >= 0) {
+                preferred_worker_ = pool_.worker_for_cpu(cpu);
+            }
+        }
+    }
+
+    //处理连接直到对端关闭或收到非法帧；返回前等待所有已分发的请求完成
+    //decoder 中可以已经包含读到的数据（例如用于区分协议的首个数据包）
+    auto run(FrameDecoder& decoder) -> void{
+        while (!broken()) {
+            FrameHeader header;
+            std::span<const char> payload;
+            while (decoder.next(header, payload)) {
+                submit(header, payload);
+            }
+            if (decoder.error()) {
+                break;
+            }
+
+            auto buf = decoder.prepare();
+            auto read_result = stream_.read(buf);
+            if (!read_result || read_result.value() == 0) {
+                break;
+            }
+            decoder.commit(read_result.value());
+        }
+
+        std::unique_lock<std::mutex> lock(inflight_mutex_);
+        inflight_done_.wait(lock, [this] { return inflight_count_ == 0; });
+    }
+
+private:
+    //一个已分发的调用；负载所在的接收缓冲区会被下一次读取覆盖，因此拷贝一份交给工作线程
+    struct Call {
+        FrameHeader header;
+        std::string args;
+        CallContext::Clock::time_point deadline{CallContext::Clock::time_point::max()};
+        std::atomic<bool> cancelled{false};
+    };
+
+    auto submit(const FrameHeader& header, std::span<const char> payload) -> void{
+        if (header.flags & kFlagCancel) {
+            cancel(header.request_id);
+            return;
+        }
+
+        auto call = std::make_shared<Call>();
+        call->header = header;
+        if (auto budget = split_deadline(header, payload)) {
+            call->deadline = CallContext::Clock::now() + budget.value();
+        }
+        call->args.assign(payload.data(), payload.size());
+        {
+            std::lock_guard<std::mutex> lock(inflight_mutex_);
+            inflight_[header.request_id] = call;
+            ++inflight_count_;
+        }
+        auto job = [this, call] { execute(*call); };
+        bool queued = preferred_worker_ ? pool_.enqueue_to(*preferred_worker_, job) : pool_.enqueue(job);
+        if (!queued) {
+            execute(*call);
+        }
+    }
+
+    //标记调用已取消：还在队列中的调用不再执行，正在执行的调用通过 CallContext 看到取消状态
+    auto cancel(uint32_t request_id) -> void{
+        std::lock_guard<std::mutex> lock(inflight_mutex_);
+        if (auto it = inflight_.find(request_id); it != inflight_.end()) {
+            it->second->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    //执行调用；排队期间已经被取消的调用直接丢弃，执行完才取消的调用不再写回响应；
+    //排队期间或执行完时已经过期的调用以 kRPCDeadlineExceeded 错误响应
+    auto execute(Call& call) -> void{
+        if (call.cancelled.load(std::memory_order_relaxed)) {
+            stats_.cancelled.fetch_add(1, std::memory_order_relaxed);
+        } else if (CallContext::Clock::now() >= call.deadline) {
+            reply_expired(call);
+        } else {
+            std::string out;
+            registry_.dispatch(call.header, call.args, out, CallContext{call.deadline, &call.cancelled});
+            if (call.cancelled.load(std::memory_order_relaxed)) {
+                stats_.cancelled.fetch_add(1, std::memory_order_relaxed);
+            } else if (CallContext::Clock::now() >= call.deadline) {
+                reply_expired(call);
+            } else {
+                stats_.completed.fetch_add(1, std::memory_order_relaxed);
+                send(std::move(out));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(inflight_mutex_);
+        if (auto it = inflight_.find(call.header.request_id); it != inflight_.end() && it->second.get() == &call) {
+            inflight_.erase(it);
+        }
+        if (--inflight_count_ == 0) {
+            inflight_done_.notify_all();
+        }
+    }
+
+    //过期的调用不返回结果，只告诉客户端已超过截止时间
+    auto reply_expired(const Call& call) -> void{
+        stats_.expired.fetch_add(1, std::memory_order_relaxed);
+        std::string out;
+        append_error(out, call.header, Error::kRPCDeadlineExceeded);
+        send(std::move(out));
+    }
+
+    //追加响应并在没有其他线程写入时负责发送，写入期间其他线程追加的响应合并到下一次发送
+    auto send(std::string frames) -> void{
+        std::unique_lock<std::mutex> lock(write_mutex_);
+        if (broken_) return;
+        pending_.append(frames);
+        if (writing_) return;
+
+        writing_ = true;
+        while (!pending_.empty() && !broken_) {
+            std::string batch;
+            batch.swap(pending_);
+            lock.unlock();
+            bool ok = send_all(stream_.fd(), batch).has_value();
+            lock.lock();
+            if (!ok) {
+                broken_ = true;
+                pending_.clear();
+            }
+        }
+        writing_ = false;
+    }
+
+    auto broken() -> bool{
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return broken_;
+    }
+
+    net::TcpStream& stream_;
+    const Registry& registry_;
+    net::ThreadPool& pool_;
+    ServerStats& stats_;
+    std::optional<size_t> preferred_worker_;    //与收包 CPU 最近的工作线程
+
+    std::mutex write_mutex_;
+    std::string pending_;       //等待发送的响应帧
+    bool writing_{false};       //是否有线程正在发送
+    bool broken_{false};        //发送失败，连接不再可用
+
+    std::mutex inflight_mutex_;
+    std::condition_variable inflight_done_;
+    std::unordered_map<uint32_t, std::shared_ptr<Call>> inflight_;    //请求 ID -> 未完成的调用（用于取消）
+    size_t inflight_count_{0};  //已分发但未完成的请求数
+};
+
+}
@@ -0,0 +1,583 @@
+#pragma once
+
+#include "saxio/net/rpc/protocol.hpp"
+#include "saxio/net/rpc/registry.hpp"
+#include "saxio/net/rpc/session.hpp"
+#include "saxio/net/fd_passing.hpp"
+#include "saxio/common/debug.hpp"
+#include "saxio/common/thread_pool.hpp"
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+
+namespace saxio::rpc{
+
+//同机 RPC 的共享内存传输
+//
+//客户端创建一个 memfd，其中包含两个单生产者单消费者的字节环（请求方向和响应方向），
+//通过 UNIX 套接字用 SCM_RIGHTS 把 memfd 交给服务器，之后的请求和响应都只在共享内存中
+//读写，帧格式与 TCP 连接完全相同，服务器按同一个 Registry 分发。
+//等待数据时先自适应自旋（多核机器上），仍没有数据再在共享内存中的 futex 上睡眠，
+//写入方只在对方睡眠时才调用 futex_wake，两端都在自旋时调用路径上没有系统调用。握手用的 UNIX 套接字保持打开，
+//用于发现对端进程退出。
+
+namespace shm {
+
+inline constexpr uint32_t kMagic = 0x48535853;   //"SXSH"
+inline constexpr uint32_t kVersion = 1;
+inline constexpr size_t kDefaultRingCapacity = 1 << 20;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory rings require lock-free atomics");
+
+//共享内存开头的描述信息
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ring_capacity;                  //每个环的数据区大小（2 的幂）
+    std::atomic<uint32_t> client_closed;     //客户端已关闭
+    std::atomic<uint32_t> server_closed;     //服务器已关闭
+};
+
+//单个环的控制块：生产者和消费者各自写的字段放在不同的缓存行
+struct RingControl {
+    alignas(64) std::atomic<uint64_t> head;             //已写入的总字节数（生产者写）
+    alignas(64) std::atomic<uint64_t> tail;             //已读取的总字节数（消费者写）
+    alignas(64) std::atomic<uint32_t> data_seq;         //有新数据时递增（futex 字）
+    std::atomic<uint32_t> consumer_waiting;
+    alignas(64) std::atomic<uint32_t> space_seq;        //有新空间时递增（futex 字）
+    std::atomic<uint32_t> producer_waiting;
+};
+
+//共享内存布局：[Header][请求环控制块][响应环控制块] 占第一页，随后是两个环的数据区
+inline constexpr size_t kControlSize = 4096;
+static_assert(alignof(RingControl) + sizeof(Header) + 2 * sizeof(RingControl) <= kControlSize);
+
+inline auto mapping_size(size_t ring_capacity) -> size_t{ return kControlSize + 2 * ring_capacity; }
+
+inline auto futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::milliseconds timeout) -> void{
+    timespec ts{static_cast<time_t>(timeout.count() / 1000), static_cast<long>(timeout.count() % 1000 * 1'000'000)};
+    //共享内存跨进程使用，不能带 FUTEX_PRIVATE_FLAG
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+inline auto futex_wake(std::atomic<uint32_t>& word) -> void{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+//字节环：一端只写、另一端只读，帧可以跨越环尾，由读端的 FrameDecoder 重新拼接
+class Ring {
+public:
+    Ring(RingControl* control, char* data, size_t capacity)
+        : control_(control), data_(data), mask_(capacity - 1){}
+
+    //写入尽可能多的数据，返回写入的字节数
+    auto write_some(std::string_view data) -> size_t{
+        uint64_t head = control_->head.load(std::memory_order_relaxed);
+        uint64_t tail = control_->tail.load(std::memory_order_acquire);
+        //tail 由对端写入，可能超过 head；已用量按环容量截断，空间不会算成超过容量
+        size_t used = std::min<uint64_t>(head - tail, mask_ + 1);
+        size_t n = std::min(data.size(), mask_ + 1 - used);
+        if (n == 0) return 0;
+
+        size_t offset = head & mask_;
+        size_t first = std::min(n, static_cast<size_t>(mask_ + 1 - offset));
+        std::memcpy(data_ + offset, data.data(), first);
+        std::memcpy(data_, data.data() + first, n - first);
+        control_->head.store(head + n, std::memory_order_release);
+
+        //发布数据与检查消费者是否睡眠之间需要全屏障，与 wait_readable 中的顺序配对
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (control_->consumer_waiting.load(std::memory_order_relaxed)) {
+            control_->data_seq.fetch_add(1, std::memory_order_release);
+            futex_wake(control_->data_seq);
+        }
+        return n;
+    }
+
+    //把所有可读数据移入 decoder，返回读取的字节数
+    auto read_into(FrameDecoder& decoder) -> size_t{
+        uint64_t tail = control_->tail.load(std::memory_order_relaxed);
+        uint64_t head = control_->head.load(std::memory_order_acquire);
+        //控制块位于对端可写的共享内存中，按环容量截断，避免越界
+        size_t n = std::min<uint64_t>(head - tail, mask_ + 1);
+        if (n == 0) return 0;
+
+        auto buf = decoder.prepare(n);
+        size_t offset = tail & mask_;
+        size_t first = std::min(n, static_cast<size_t>(mask_ + 1 - offset));
+        std::memcpy(buf.data(), data_ + offset, first);
+        std::memcpy(buf.data() + first, data_, n - first);
+        decoder.commit(n);
+        control_->tail.store(tail + n, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (control_->producer_waiting.load(std::memory_order_relaxed)) {
+            control_->space_seq.fetch_add(1, std::memory_order_release);
+            futex_wake(control_->space_seq);
+        }
+        return n;
+    }
+
+    //唤醒等待数据的消费者（用于通知对端关闭）
+    auto notify() -> void{
+        control_->data_seq.fetch_add(1, std::memory_order_release);
+        futex_wake(control_->data_seq);
+    }
+
+    //等待可读数据：先自旋，再睡眠到有数据或超时；返回是否有数据
+    auto wait_readable(std::chrono::milliseconds timeout) -> bool{
+        return wait([this] { return readable(); }, control_->data_seq, control_->consumer_waiting, timeout);
+    }
+
+    //等待可写空间
+    auto wait_writable(std::chrono::milliseconds timeout) -> bool{
+        return wait([this] { return writable(); }, control_->space_seq, control_->producer_waiting, timeout);
+    }
+
+private:
+    auto readable() const -> bool{
+        return control_->head.load(std::memory_order_acquire) != control_->tail.load(std::memory_order_relaxed);
+    }
+
+    auto writable() const -> bool{
+        return control_->head.load(std::memory_order_relaxed) - control_->tail.load(std::memory_order_acquire) <= mask_;
+    }
+
+    //自适应自旋：自旋期间等到了就加长下一次的自旋，睡眠了就缩短，
+    //连续调用时停留在自旋路径，空闲时很快退回 futex 睡眠不占用 CPU
+    template <typename Ready>
+    auto wait(Ready ready, std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting,
+              std::chrono::milliseconds timeout) -> bool{
+        if (ready()) return true;
+        if (spin_enabled()) {
+            for (uint32_t i = 0; i < spin_limit_; ++i) {
+                if (ready()) {
+                    spin_limit_ = std::min(spin_limit_ * 2, kMaxSpin);
+                    return true;
+                }
+                net::detail::cpu_relax();
+            }
+            spin_limit_ = std::max(spin_limit_ / 2, kMinSpin);
+        }
+
+        waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t expected = seq.load(std::memory_order_acquire);
+        if (!ready()) {
+            futex_wait(seq, expected, timeout);
+        }
+        waiting.store(0, std::memory_order_relaxed);
+        return ready();
+    }
+
+    //单核机器上自旋只会占用对端需要的时间片，直接睡眠
+    static auto spin_enabled() -> bool{
+        static const bool enabled = std::thread::hardware_concurrency() > 1;
+        return enabled;
+    }
+
+    static constexpr uint32_t kMinSpin = 64;
+    static constexpr uint32_t kMaxSpin = 1 << 16;
+
+    RingControl* control_;
+    char* data_;
+    size_t mask_;
+    uint32_t spin_limit_{1024};
+};
+
+//一段映射好的共享内存，拥有 memfd 和映射
+class Mapping {
+public:
+    Mapping() = default;
+    Mapping(const Mapping&) = delete;
+    auto operator=(const Mapping&) -> Mapping& = delete;
+
+    ~Mapping(){
+        if (base_ != nullptr) ::munmap(base_, size_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    //创建新的共享内存并初始化（客户端）
+    static auto create(size_t ring_capacity) -> std::unique_ptr<Mapping>{
+        ring_capacity = std::bit_ceil(std::max<size_t>(ring_capacity, 4096));
+        int fd = ::memfd_create("saxio-rpc-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) return nullptr;
+        //定好大小后封住，双方映射期间都不能再改变文件大小，访问映射不会因文件被截断而 SIGBUS
+        if (::ftruncate(fd, static_cast<off_t>(mapping_size(ring_capacity))) < 0
+            || ::fcntl(fd, F_ADD_SEALS, kRequiredSeals) < 0) {
+            ::close(fd);
+            return nullptr;
+        }
+        auto mapping = map(fd, mapping_size(ring_capacity));
+        if (!mapping) return nullptr;
+
+        //ftruncate 得到的内存全为 0，原子变量的初始值即为 0
+        Header* header = mapping->header();
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->ring_capacity = ring_capacity;
+        mapping->capacity_ = ring_capacity;
+        return mapping;
+    }
+
+    //映射对端传来的共享内存并校验（服务器）
+    static auto attach(int fd) -> std::unique_ptr<Mapping>{
+        //没有封住大小的文件，对端之后可以截断它，让服务器访问映射时收到 SIGBUS
+        int seals = ::fcntl(fd, F_GET_SEALS);
+        struct stat st{};
+        if (seals < 0 || (seals & kRequiredSeals) != kRequiredSeals
+            || ::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < kControlSize) {
+            ::close(fd);
+            return nullptr;
+        }
+        auto mapping = map(fd, static_cast<size_t>(st.st_size));
+        if (!mapping) return nullptr;
+
+        const Header* header = mapping->header();
+        size_t capacity = header->ring_capacity;
+        if (header->magic != kMagic || header->version != kVersion || !std::has_single_bit(capacity)
+            || mapping_size(capacity) != mapping->size_) {
+            return nullptr;
+        }
+        mapping->capacity_ = capacity;
+        return mapping;
+    }
+
+    auto fd() const -> int{ return fd_; }
+    auto ring_capacity() const -> size_t{ return capacity_; }
+    auto header() const -> Header*{ return reinterpret_cast<Header*>(base_); }
+
+    //请求方向（客户端写、服务器读）和响应方向的环
+    auto request_ring() const -> Ring{ return ring(0); }
+    auto response_ring() const -> Ring{ return ring(1); }
+
+private:
+    static constexpr int kRequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW;
+
+    static auto map(int fd, size_t size) -> std::unique_ptr<Mapping>{
+        void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            ::close(fd);
+            return nullptr;
+        }
+        auto mapping = std::make_unique<Mapping>();
+        mapping->fd_ = fd;
+        mapping->base_ = static_cast<char*>(base);
+        mapping->size_ = size;
+        return mapping;
+    }
+
+    auto ring(size_t index) const -> Ring{
+        size_t capacity = capacity_;
+        constexpr size_t kControlOffset = (sizeof(Header) + alignof(RingControl) - 1) & ~(alignof(RingControl) - 1);
+        auto* control = reinterpret_cast<RingControl*>(base_ + kControlOffset) + index;
+        return Ring(control, base_ + kControlSize + index * capacity, capacity);
+    }
+
+    int fd_{-1};
+    char* base_{nullptr};
+    size_t size_{0};
+    size_t capacity_{0};      //校验后的环容量，不再从共享内存读取
+};
+
+//把数据完整写入环，空间不足时等待；对端关闭时返回 false
+inline auto write_all(Ring& ring, std::string_view data, const std::atomic<uint32_t>& peer_closed) -> bool{
+    while (!data.empty()) {
+        data.remove_prefix(ring.write_some(data));
+        if (data.empty()) break;
+        if (peer_closed.load(std::memory_order_acquire)) return false;
+        ring.wait_writable(std::chrono::milliseconds(50));
+    }
+    return true;
+}
+
+} // namespace shm
+
+//共享内存 RPC 客户端：同步调用，同一时刻只有一个调用在进行（多线程调用时串行）
+class ShmClient {
+public:
+    ShmClient(int sock, std::unique_ptr<shm::Mapping> mapping)
+        : sock_(sock), mapping_(std::move(mapping)),
+          requests_(mapping_->request_ring()), responses_(mapping_->response_ring()){}
+
+    ShmClient(const ShmClient&) = delete;
+    auto operator=(const ShmClient&) -> ShmClient& = delete;
+
+    ~ShmClient(){
+        mapping_->header()->client_closed.store(1, std::memory_order_release);
+        //唤醒可能在等待请求的服务器线程
+        requests_.notify();
+        ::close(sock_);
+    }
+
+    //连接服务器的 UNIX 套接字，创建共享内存并完成握手
+    static auto connect(const std::string& path, size_t ring_capacity = shm::kDefaultRingCapacity)
+        -> Result<std::unique_ptr<ShmClient>>{
+        int sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sock < 0) {
+            return std::unexpected{make_error(Error::kSocketCreateFailed)};
+        }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        if (::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(sock);
+            return std::unexpected{make_error(Error::kClientConnectFailed)};
+        }
+
+        auto mapping = shm::Mapping::create(ring_capacity);
+        char ack = 0;
+        if (!mapping || !net::detail::send_fds(sock, {mapping->fd()}) || ::read(sock, &ack, 1) != 1 || ack != 'K') {
+            ::close(sock);
+            return std::unexpected{make_error(Error::kFdPassingFailed)};
+        }
+        return std::make_unique<ShmClient>(sock, std::move(mapping));
+    }
+
+    //同步调用，R 为方法的返回值类型
+    template <typename R, typename... Args>
+    auto call(uint32_t method_id, const Args&... args) -> Result<R>{
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t request_id = next_request_id_++;
+        frame_.clear();
+        append_header(frame_, {0, method_id, request_id, 0});
+        PayloadWriter writer{frame_};
+        (encode_arg(writer, args), ...);
+        patch_payload_size(frame_, 0);
+
+        const auto& server_closed = mapping_->header()->server_closed;
+        if (!shm::write_all(requests_, frame_, server_closed)) {
+            return std::unexpected{make_error(Error::kWriteFailed)};
+        }
+
+        while (true) {
+            FrameHeader header;
+            std::span<const char> payload;
+            while (decoder_.next(header, payload)) {
+                if (header.request_id != request_id) continue;
+                if (header.flags & kFlagError) {
+                    auto code = PayloadReader{payload}.read<int32_t>();
+                    return std::unexpected{make_error(code ? code.value() : Error::kUnknown)};
+                }
+                if constexpr (std::is_void_v<R>) {
+                    return {};
+                } else {
+                    PayloadReader reader{payload};
+                    auto value = detail::Codec<R>::decode(reader);
+                    if (!value) return std::unexpected{make_error(Error::kRPCParameterParsingFailed)};
+                    return std::move(value.value());
+                }
+            }
+            if (decoder_.error() || server_closed.load(std::memory_order_acquire)) {
+                return std::unexpected{make_error(Error::kReadFailed)};
+            }
+            if (responses_.read_into(decoder_) == 0) {
+                responses_.wait_readable(std::chrono::milliseconds(50));
+            }
+        }
+    }
+
+    template <typename R, typename... Args>
+    auto call(Method method, const Args&... args) -> Result<R>{
+        return call<R>(static_cast<uint32_t>(method), args...);
+    }
+
+private:
+    template <typename T>
+    static auto encode_arg(PayloadWriter& writer, const T& value) -> void{
+        if constexpr (std::is_convertible_v<const T&, std::string_view> && !std::is_arithmetic_v<T>) {
+            detail::Codec<std::string_view>::encode(writer, value);
+        } else {
+            detail::Codec<T>::encode(writer, value);
+        }
+    }
+
+    int sock_;
+    std::unique_ptr<shm::Mapping> mapping_;
+    shm::Ring requests_;
+    shm::Ring responses_;
+    std::mutex mutex_;
+    std::string frame_;             //复用的请求缓冲区
+    FrameDecoder decoder_;
+    uint32_t next_request_id_{1};
+};
+
+//共享内存 RPC 服务器：在 UNIX 套接字上接受握手，每个客户端一个轮询线程，
+//请求在轮询线程上直接按 Registry 分发（与 dispatch_rpc_frame 相同的路径），不经过线程池
+class ShmServer {
+public:
+    ShmServer(std::string path, const Registry& registry, ServerStats& stats)
+        : path_(std::move(path)), registry_(registry), stats_(stats){}
+
+    ShmServer(const ShmServer&) = delete;
+    auto operator=(const ShmServer&) -> ShmServer& = delete;
+
+    ~ShmServer(){ stop(); }
+
+    //绑定 UNIX 套接字并在后台线程中接受连接
+    auto start() -> Result<void>{
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            return std::unexpected{make_error(Error::kSocketCreateFailed)};
+        }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+        ::unlink(path_.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            return std::unexpected{make_error(Error::kBindFailed)};
+        }
+        if (::listen(listen_fd_, SOMAXCONN) < 0) {
+            return std::unexpected{make_error(Error::kListenFailed)};
+        }
+        accept_thread_ = std::thread([this] { accept_loop(); });
+        return {};
+    }
+
+    //停止接受连接并等待所有轮询线程退出
+    auto stop() -> void{
+        if (stopping_.exchange(true)) return;
+        if (listen_fd_ >= 0) {
+            ::shutdown(listen_fd_, SHUT_RDWR);
+        }
+        if (accept_thread_.joinable()) accept_thread_.join();
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            ::unlink(path_.c_str());
+            listen_fd_ = -1;
+        }
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto& session : sessions_) {
+            if (session.thread.joinable()) session.thread.join();
+        }
+        sessions_.clear();
+    }
+
+private:
+    //一个客户端会话的轮询线程，线程结束前置位 done，由 accept 线程回收
+    struct Session {
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    //回收已经结束的会话线程，避免客户端反复连接断开时线程对象不断累积
+    auto reap_sessions() -> void{
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (auto it = sessions_.begin(); it != sessions_.end();) {
+            if (it->done.load(std::memory_order_acquire)) {
+                it->thread.join();
+                it = sessions_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    auto accept_loop() -> void{
+        while (!stopping_) {
+            reap_sessions();
+            pollfd pfd{listen_fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, 200) <= 0) continue;
+            int sock = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (sock < 0) continue;
+
+            //握手在会话线程中进行，不发送 memfd 的客户端不会阻塞 accept 线程
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            Session& session = sessions_.emplace_back();
+            session.thread = std::thread([this, &session, sock] {
+                if (auto mapping = handshake(sock)) {
+                    LOG_INFO("Shared memory RPC client attached, ring capacity {}", mapping->ring_capacity());
+                    serve(*mapping, sock);
+                } else {
+                    LOG_WARN("Shared memory RPC handshake failed on fd {}", sock);
+                }
+                ::close(sock);
+                session.done.store(true, std::memory_order_release);
+            });
+        }
+    }
+
+    //等待客户端发来 memfd（最多 kHandshakeTimeout，stop() 时立即放弃），校验后回复 "K"
+    auto handshake(int sock) -> std::unique_ptr<shm::Mapping>{
+        auto deadline = std::chrono::steady_clock::now() + kHandshakeTimeout;
+        while (true) {
+            if (stopping_ || std::chrono::steady_clock::now() >= deadline) return nullptr;
+            pollfd pfd{sock, POLLIN, 0};
+            int ret = ::poll(&pfd, 1, 100);
+            if (ret < 0 && errno != EINTR) return nullptr;
+            if (ret > 0) break;
+        }
+        auto fds = net::detail::recv_fds(sock, 1);
+        auto mapping = fds.size() == 1 ? shm::Mapping::attach(fds[0]) : nullptr;
+        if (!mapping || ::write(sock, "K", 1) != 1) return nullptr;
+        return mapping;
+    }
+
+    //轮询请求环直到客户端关闭：长时间没有请求时检查握手套接字，发现客户端进程退出
+    auto serve(shm::Mapping& mapping, int sock) -> void{
+        shm::Header* header = mapping.header();
+        shm::Ring requests = mapping.request_ring();
+        shm::Ring responses = mapping.response_ring();
+        FrameDecoder decoder;
+        std::string out;
+
+        while (!stopping_ && !header->client_closed.load(std::memory_order_acquire)) {
+            if (requests.read_into(decoder) == 0) {
+                if (!requests.wait_readable(std::chrono::milliseconds(50)) && peer_gone(sock)) break;
+                continue;
+            }
+
+            FrameHeader frame;
+            std::span<const char> payload;
+            while (decoder.next(frame, payload)) {
+                CallContext context;
+                if (auto budget = split_deadline(frame, payload)) {
+                    context = CallContext{CallContext::Clock::now() + budget.value(), nullptr};
+                }
+                registry_.dispatch(frame, payload, out, context);
+                stats_.completed.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (decoder.error()) break;
+            if (!shm::write_all(responses, out, header->client_closed)) break;
+            out.clear();
+        }
+        header->server_closed.store(1, std::memory_order_release);
+        responses.notify();
+    }
+
+    static auto peer_gone(int sock) -> bool{
+        pollfd pfd{sock, POLLRDHUP, 0};
+        return ::poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR));
+    }
+
+    static constexpr auto kHandshakeTimeout = std::chrono::seconds(2);
+
+    std::string path_;
+    const Registry& registry_;
+    ServerStats& stats_;
+    int listen_fd_{-1};
+    std::atomic<bool> stopping_{false};
+    std::thread accept_thread_;
+    std::mutex sessions_mutex_;
+    std::list<Session> sessions_;       //链表保证元素地址不变，线程可以持有自己的 Session
+};
+
+}
@@ -0,0 +1,42 @@
+#include "saxio/net/http/compression.hpp"
+#include <iostream>
+#include <string_view>
+
+using namespace saxio;
+
+struct Case {
+    std::string_view accept_encoding;
+    bool allow_deflate;
+    http::ContentEncoding expected;
+};
+
+//Accept-Encoding 协商：q=0 禁止的编码不能再通过 "*" 选中
+auto main() -> int {
+    const Case cases[] = {
+        {"", true, http::ContentEncoding::IDENTITY},
+        {"gzip, deflate", true, http::ContentEncoding::GZIP},
+        {"gzip;q=0.5, deflate", true, http::ContentEncoding::DEFLATE},
+        {"gzip;q=0.5, deflate", false, http::ContentEncoding::GZIP},
+        {"*", true, http::ContentEncoding::GZIP},
+        {"gzip;q=0, *", true, http::ContentEncoding::DEFLATE},
+        {"gzip;q=0, *", false, http::ContentEncoding::IDENTITY},
+        {"*, gzip;q=0", false, http::ContentEncoding::IDENTITY},
+        {"gzip;q=0, deflate;q=0, *", true, http::ContentEncoding::IDENTITY},
+        {"*;q=0", true, http::ContentEncoding::IDENTITY},
+        {"*;q=0, deflate", true, http::ContentEncoding::DEFLATE},
+        {"br, x-gzip;q=0.3", true, http::ContentEncoding::GZIP},
+    };
+
+    int failed = 0;
+    for (const auto& c : cases) {
+        auto got = http::negotiate_encoding(c.accept_encoding, c.allow_deflate);
+        if (got != c.expected) {
+            std::cerr << "\"" << c.accept_encoding << "\" (deflate " << c.allow_deflate << "): got "
+                      << http::get_encoding_name(got) << ", expected "
+                      << http::get_encoding_name(c.expected) << "\n";
+            ++failed;
+        }
+    }
+    std::cout << std::size(cases) - failed << "/" << std::size(cases) << " negotiation cases passed\n";
+    return failed == 0 ? 0 : -1;
+}
@@ -1,9 +1,55 @@
 #include "saxio/net/http/server.hpp"
+#include "saxio_assets/doc_assets.hpp"
 
-auto main() -> int{
+//用法：http [文档根目录]，默认使用当前目录下的 doc
+auto main(int argc, char* argv[]) -> int{
     try {
         //创建HTTP服务器示例，监听8090端口
         saxio::http::Server server(8090);
+
+        //构建时嵌入的 doc 目录：/img.png 等资源直接从程序内存发送，不访问文件系统
+        server.handler().mount_embedded("/", saxio::assets::doc_assets::table);
+
+        //静态文件：嵌入资源之外的文件从文档根目录发送，无需逐个编写处理函数
+        server.handler().mount_static("/", argc > 1 ? argv[1] : "doc");
+
+        //图片长期缓存，首页每次都向服务器校验（命中时只返回304）
+        server.handler().set_cache_control("/img.png", "public, max-age=3600");
+        server.handler().set_cache_control("/", "no-cache");
+
+        //WebSocket 回显：一个长连接代替轮询
+        server.handler().set_websocket_handler("/ws", [](saxio::http::WebSocket& ws) {
+            while (auto message = ws.receive()) {
+                if (message->type == saxio::http::ws::Opcode::CLOSE) break;
+                if (message->type == saxio::http::ws::Opcode::TEXT) {
+                    (void)ws.send_text(message->data);
+                } else if (message->type == saxio::http::ws::Opcode::BINARY) {
+                    (void)ws.send_binary(message->data);
+                }
+            }
+        });
+
+        //动态页面：相同路径 1 秒内只计算一次，其余请求直接发送缓存的响应
+        server.handler().add_route("/time", [](saxio::net::TcpStream& stream,
+                                               const saxio::http::HttpRequest&, saxio::http::BodyReader&) {
+            saxio::http::ResponseUtils::send_simple_response(stream, saxio::http::HttpStatus::OK,
+                saxio::http::format_http_date(std::time(nullptr)) + "\n");
+        });
+        server.handler().enable_response_cache("/time", std::chrono::seconds(1));
+
+        //过载保护：最多 1024 个连接、64 个同时处理的请求，排队超过 50ms 持续 500ms 后开始拒绝
+        server.admission().set_max_connections(1024);
+        server.admission().set_max_inflight_requests(64);
+        server.admission().set_queue_delay(std::chrono::milliseconds(50), std::chrono::milliseconds(500));
+        server.admission().set_retry_after(std::chrono::seconds(2));
+
+        //每个 IP 每秒最多 20 个新连接、100 个请求，上传接口单独限制为每秒 2 次
+        server.rate_limits().set_connection_rate(20, 40);
+        server.rate_limits().set_request_rate(100, 200);
+        server.rate_limits().set_route_rate("/upload", 2, 5);
+
+        //允许最大 4GB 的上传，上传内容直接写入文件，内存占用恒定
+        server.set_max_body_size(4ULL * 1024 * 1024 * 1024);
         LOG_INFO("Starting HTTP server...");
 
         //启动服务器
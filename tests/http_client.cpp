@@ -0,0 +1,56 @@
+#include "saxio/net/http/client.hpp"
+#include <iostream>
+#include <vector>
+
+using namespace saxio::http;
+
+auto main(int argc, char* argv[]) -> int{
+    std::string url = argc > 1 ? argv[1] : "http://127.0.0.1:8090/";
+
+    Client client;
+    client.set_connect_timeout(std::chrono::seconds(2));
+    client.set_io_timeout(std::chrono::seconds(5));
+
+    //连续请求：服务器支持 keep-alive 时复用同一个连接
+    for (int i = 0; i < 3; ++i) {
+        auto response = client.get(url);
+        if (!response) {
+            std::cerr << "请求失败: " << response.error().message() << std::endl;
+            return 1;
+        }
+        std::cout << "GET " << url << " -> " << response->status << " " << response->reason
+                  << ", " << response->body.size() << " 字节，空闲连接: "
+                  << client.idle_connections() << std::endl;
+    }
+
+    //流水线：一次发送多个请求，按顺序读取响应
+    std::vector<ClientRequest> requests(3, ClientRequest{"GET", url, {}, {}, {}});
+    if (auto responses = client.pipeline(requests); responses) {
+        for (const auto& response : responses.value()) {
+            std::cout << "流水线响应: " << response.status << ", " << response.body.size() << " 字节" << std::endl;
+        }
+    } else {
+        std::cerr << "流水线请求失败: " << responses.error().message() << std::endl;
+        return 1;
+    }
+
+    //流式读取响应体，内存占用与响应大小无关
+    auto stream = client.open(ClientRequest{"GET", url, {}, {}, {}});
+    if (!stream) {
+        std::cerr << "请求失败: " << stream.error().message() << std::endl;
+        return 1;
+    }
+    char buf[4096];
+    size_t total = 0;
+    while (true) {
+        auto n = stream->read({buf, sizeof(buf)});
+        if (!n) {
+            std::cerr << "读取响应体失败: " << n.error().message() << std::endl;
+            return 1;
+        }
+        if (n.value() == 0) break;
+        total += n.value();
+    }
+    std::cout << "流式读取: " << stream->head().status << ", " << total << " 字节" << std::endl;
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "saxio/net/http/server.hpp"
+#include "saxio/net/prefork.hpp"
+
+using namespace saxio;
+
+//prefork 示例：master 持有 8090 端口的监听套接字，4 个 worker 共享它提供静态文件服务
+//  kill -HUP  <master>   滚动重启 worker
+//  kill -USR2 <master>   二进制升级（重新执行磁盘上的程序，监听套接字不关闭）
+//  kill -TERM <master>   优雅退出
+//用法：http_prefork [文档根目录]
+auto main(int argc, char* argv[]) -> int{
+    std::string document_root = argc > 1 ? argv[1] : "doc";
+
+    net::Master master(8090, 4);
+    auto ret = master.run([&document_root](net::TcpListener& listener) {
+        http::Server server(8090);
+        server.handler().mount_static("/", document_root);
+        net::Master::on_worker_stop([&server] { server.stop(); });
+
+        if (auto served = server.serve(listener); !served) {
+            LOG_ERROR("Worker {} error: {}", ::getpid(), served.error());
+        }
+    });
+    if (!ret) {
+        LOG_ERROR("Master error: {}", ret.error());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "saxio/net/http/server.hpp"
+#include "saxio/net/http/proxy.hpp"
+#include <thread>
+
+using namespace saxio::http;
+
+//反向代理示例：在本机启动三个上游服务器（8101-8103），代理监听 8100
+//用法：http_proxy [round_robin|least_conn|hash]
+auto main(int argc, char* argv[]) -> int{
+    std::string mode = argc > 1 ? argv[1] : "round_robin";
+    auto strategy = BalanceStrategy::ROUND_ROBIN;
+    if (mode == "least_conn") strategy = BalanceStrategy::LEAST_CONNECTIONS;
+    if (mode == "hash") strategy = BalanceStrategy::CONSISTENT_HASH;
+
+    std::vector<std::string> upstreams;
+    for (uint16_t port = 8101; port <= 8103; ++port) {
+        upstreams.push_back(std::format("http://127.0.0.1:{}", port));
+
+        //上游服务器：返回自己的端口和请求路径，读取并统计请求体
+        std::thread([port]() {
+            Server upstream(port);
+            upstream.set_max_body_size(4ULL * 1024 * 1024 * 1024);
+            upstream.handler().add_route("/", [port](saxio::net::TcpStream& stream,
+                                                     const HttpRequest& request, BodyReader& body) {
+                auto received = body.discard();
+                std::string reply = std::format("upstream {} {} {} body={}\n", port, request.method,
+                                                request.path, received ? received.value() : 0);
+                ResponseUtils::send_simple_response(stream, HttpStatus::OK, reply);
+            });
+            if (auto ret = upstream.start(); !ret) {
+                LOG_ERROR("Upstream {} error: {}", port, ret.error());
+            }
+        }).detach();
+    }
+
+    ReverseProxy proxy(upstreams, strategy);
+    proxy.set_max_fails(2);
+    proxy.set_fail_timeout(std::chrono::seconds(5));
+    proxy.client().set_io_timeout(std::chrono::seconds(10));
+
+    Server server(8100);
+    server.set_max_body_size(4ULL * 1024 * 1024 * 1024);
+    server.handler().add_route("/", [&proxy](saxio::net::TcpStream& stream,
+                                             const HttpRequest& request, BodyReader& body) {
+        proxy.handle(stream, request, body);
+    });
+    LOG_INFO("Starting reverse proxy ({}) on port 8100...", mode);
+    if (auto ret = server.start(); !ret) {
+        LOG_ERROR("Proxy server error: {}", ret.error());
+        return -1;
+    }
+    return 0;
+}
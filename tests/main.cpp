@@ -18,6 +18,8 @@ using namespace saxio::net;
 std::unordered_map<int, std::shared_ptr<std::thread>> clients;
 std::mutex clients_mutex;
 std::atomic<bool> server_running{true};
+//最大并发连接数，超出的连接直接拒绝，避免线程数无限增长
+constexpr size_t kMaxClients = 256;
 
 void process(TcpStream stream) {
     int client_fd = stream.fd();
@@ -142,6 +144,11 @@ auto server() -> saxio::Result<void> {
 
         // 启动新线程处理连接
         std::lock_guard<std::mutex> lock(clients_mutex);
+        if (clients.size() >= kMaxClients) {
+            LOG_WARN("Too many clients ({}), rejecting client {}", clients.size(), client_fd);
+            (void)stream.write("Server busy, please try again later\n");
+            continue;
+        }
 
         // 使用智能指针管理线程
         auto client_thread = std::make_shared<std::thread>([stream = std::move(stream)]() mutable {
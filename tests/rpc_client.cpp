@@ -1,10 +1,14 @@
 #include "saxio/net.hpp"
+#include "saxio/net/rpc/client.hpp"
+#include "saxio/net/rpc/shm_transport.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <thread>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 using namespace saxio::net;
 
@@ -93,12 +97,80 @@ bool validate_input(const std::string& input) {
     return true;
 }
 
-auto main() -> int {
+// 压测模式：多个线程通过连接池以流水线方式发起二进制 RPC 调用
+int run_bench(const sockaddr_in& addr, size_t total_calls, size_t connections) {
+    saxio::rpc::ClientPool pool({addr}, connections);
+    pool.set_default_timeout(std::chrono::seconds(5));
+
+    constexpr size_t kThreads = 4;
+    constexpr size_t kWindow = 256;   // 每个线程同时未完成的调用数
+    std::atomic<size_t> failed{0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<std::future<saxio::Result<double>>> window;
+            for (size_t i = t; i < total_calls; i += kThreads) {
+                window.push_back(pool.call<double>(saxio::rpc::Method::ADD, double(i), 1.0));
+                if (window.size() == kWindow) {
+                    for (auto& f : window) if (!f.get()) ++failed;
+                    window.clear();
+                }
+            }
+            for (auto& f : window) if (!f.get()) ++failed;
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << total_calls << " 次调用, " << connections << " 个连接, 失败 " << failed.load()
+              << ", 耗时 " << seconds << " s, QPS " << static_cast<size_t>(total_calls / seconds) << std::endl;
+
+    // 批量调用：一次往返完成一万次加法
+    std::vector<double> a(10000, 1.5), b(10000, 2.5);
+    if (auto batch = pool.call_batch(saxio::rpc::Method::ADD, a, b).get(); batch) {
+        std::cout << "批量调用 " << batch->size() << " 次加法, 第一个结果: " << batch->front() << std::endl;
+    }
+    return failed.load() == 0 ? 0 : -1;
+}
+
+// 共享内存模式：同机调用，测量单个调用的往返时间
+int run_shm_bench(size_t total_calls) {
+    auto client = saxio::rpc::ShmClient::connect("/tmp/saxio_rpc.sock");
+    if (!client) {
+        std::cerr << "共享内存握手失败: " << client.error().message() << std::endl;
+        return -1;
+    }
+
+    size_t failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < total_calls; ++i) {
+        if (!(*client)->call<double>(saxio::rpc::Method::ADD, double(i), 1.0)) ++failed;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << total_calls << " 次共享内存调用, 失败 " << failed
+              << ", 平均往返 " << static_cast<size_t>(ns / total_calls) << " ns" << std::endl;
+    return failed == 0 ? 0 : -1;
+}
+
+auto main(int argc, char* argv[]) -> int {
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = htonl(INADDR_ANY);
     addr.sin_port = htons(8082);
 
+    // rpc_client bench [调用次数] [连接数]
+    if (argc > 1 && std::string_view(argv[1]) == "bench") {
+        size_t calls = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+        size_t connections = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2;
+        return run_bench(addr, calls, connections);
+    }
+    // rpc_client shm [调用次数]
+    if (argc > 1 && std::string_view(argv[1]) == "shm") {
+        return run_shm_bench(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000);
+    }
+
     auto stream_result = TcpStream::connect_client(
         reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
 
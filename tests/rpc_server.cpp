@@ -1,5 +1,7 @@
 #include "saxio/net.hpp"
 #include "saxio/net/rpc/rpc_handle.hpp"
+#include "saxio/net/rpc/session.hpp"
+#include "saxio/net/rpc/shm_transport.hpp"
 #include "saxio/log/logger.hpp"
 #include "saxio/common/debug.hpp"
 #include "saxio/net/tcp/stream.hpp"
@@ -10,6 +12,8 @@
 #include <unordered_map>
 #include <atomic>
 #include <memory>
+#include <cmath>
+#include <format>
 
 
 using namespace saxio::net;
@@ -19,32 +23,20 @@ std::unordered_map<int, std::shared_ptr<std::thread>> clients;
 std::mutex clients_mutex;
 std::atomic<bool> server_running{true};
 
-void process(TcpStream stream) {
+// 所有二进制连接共享的 RPC 工作线程，按 NUMA 节点依次绑定到各个 CPU
+const size_t rpc_worker_count = std::max(2u, std::thread::hardware_concurrency());
+saxio::net::ThreadPool rpc_workers(rpc_worker_count, 4096, saxio::net::ThreadPool::QueueMode::kMutex,
+                                   saxio::net::spread_cpus(rpc_worker_count));
+saxio::rpc::ServerStats rpc_stats;
+const auto connection_affinity = saxio::net::ConnectionAffinity::incoming_node();
+
+//文本协议（调试用）：每次读取一行 "add 1 2"，返回结果或 "ERROR"
+void process_text(TcpStream& stream, std::string_view first_data) {
     std::vector<char> buf(4096);
     int client_fd = stream.fd();
-
-    LOG_INFO("Start processing RPC client: {}", client_fd);
+    std::string_view received_data = first_data;
 
     while (true) {
-        // 读取数据
-        auto read_result = stream.read({buf.data(), buf.size()});
-        if (!read_result) {
-            if (read_result.error().value() == 0) {
-                LOG_INFO("Client closed gracefully: {}", client_fd);
-            } else {
-                LOG_ERROR("Recv failed: {} - {}", client_fd, read_result.error());
-            }
-            break;
-        }
-
-        auto bytes_read = read_result.value();
-        if (bytes_read == 0) {
-            LOG_INFO("Client closed connection: {}", client_fd);
-            break;
-        }
-
-        std::string_view received_data(buf.data(), bytes_read);
-
         // 处理空数据
         if (received_data.empty() ||
             (received_data.size() == 1 && received_data[0] == '\n')) {
@@ -53,41 +45,69 @@ void process(TcpStream stream) {
                 LOG_DEBUG("Client disconnected during empty reply: {}", client_fd);
                 break;
             }
-            continue;
-        }
-
-        // 移除换行符
-        if (!received_data.empty() && received_data.back() == '\n') {
-            received_data.remove_suffix(1);
-        }
-
-        // 处理退出连接
-        if (received_data == "quit") {
-            LOG_INFO("Client requested quit: {}", client_fd);
-            break;
-        }
+        } else {
+            // 移除换行符
+            if (!received_data.empty() && received_data.back() == '\n') {
+                received_data.remove_suffix(1);
+            }
 
-        // 处理RPC请求
-        LOG_INFO("Received RPC request from client {}: {}", client_fd, received_data);
-        auto result = saxio::rpc::dispatch_rpc_call(received_data);
+            // 处理退出连接
+            if (received_data == "quit") {
+                LOG_INFO("Client requested quit: {}", client_fd);
+                break;
+            }
 
-        if (result) {
-            std::string response = std::to_string(result.value());
-            // 发送成功响应
+            // 处理RPC请求
+            LOG_INFO("Received RPC request from client {}: {}", client_fd, received_data);
+            auto result = saxio::rpc::dispatch_rpc_call(received_data);
+            std::string response = result ? std::move(result.value()) : "ERROR";
             if (auto wr = stream.write(std::string_view(response)); !wr) {
                 LOG_ERROR("Failed to send response to client {}: {}", client_fd, wr.error());
                 break;
             }
             LOG_INFO("Sent response to client {}: {}", client_fd, response);
-        } else {
-            std::string_view response = "ERROR";
-            // 发送错误响应
-            if (auto wr = stream.write(response); !wr) {
-                LOG_ERROR("Failed to send error response to client {}: {}", client_fd, wr.error());
-                break;
-            }
-            LOG_INFO("Sent error response to client {}: {}", client_fd, response);
         }
+
+        // 读取数据
+        auto read_result = stream.read({buf.data(), buf.size()});
+        if (!read_result || read_result.value() == 0) {
+            LOG_INFO("Client closed connection: {}", client_fd);
+            break;
+        }
+        received_data = std::string_view(buf.data(), read_result.value());
+    }
+}
+
+//二进制协议：请求按请求 ID 分发到线程池，响应按完成顺序写回
+void process_binary(TcpStream& stream, saxio::rpc::FrameDecoder& decoder) {
+    saxio::rpc::Session session(stream, saxio::rpc::default_registry(), rpc_workers, rpc_stats);
+    session.run(decoder);
+    if (decoder.error()) {
+        LOG_WARN("Bad RPC frame from client {}", stream.fd());
+    }
+    LOG_INFO("Client closed connection: {}", stream.fd());
+}
+
+void process(TcpStream stream) {
+    int client_fd = stream.fd();
+    LOG_INFO("Start processing RPC client: {}", client_fd);
+
+    //连接线程留在收包 CPU 所在的 NUMA 节点上，之后分配的接收缓冲区也落在本地内存
+    if (auto pinned = connection_affinity.apply(client_fd); !pinned) {
+        LOG_WARN("Failed to pin RPC client {}: {}", client_fd, pinned.error());
+    }
+
+    //按首字节区分二进制帧和文本协议
+    saxio::rpc::FrameDecoder decoder;
+    auto buf = decoder.prepare();
+    auto read_result = stream.read(buf);
+    if (!read_result || read_result.value() == 0) {
+        LOG_INFO("Client closed connection: {}", client_fd);
+    } else if (static_cast<uint8_t>(buf[0]) == saxio::rpc::kFrameMagic) {
+        decoder.commit(read_result.value());
+        process_binary(stream, decoder);
+    } else {
+        process_text(stream, std::string_view(buf.data(), read_result.value()));
     }
 
     // 清理客户端
@@ -168,6 +188,30 @@ auto server() -> saxio::Result<void> {
 auto main(int argc, char* argv[]) -> int {
     try {
         LOG_INFO("Starting RPC Server...");
+
+        //注册自定义方法：参数解码和结果编码由函数签名自动生成
+        auto& registry = saxio::rpc::default_registry();
+        registry.register_method("pow", [](double base, double exp) { return std::pow(base, exp); });
+        registry.register_method("echo", [](std::string_view text) { return std::string(text); });
+        // 慢方法：分段休眠，调用被取消或超过截止时间时提前返回
+        registry.register_method("sleep", [](const saxio::rpc::CallContext& context, uint32_t ms) {
+            auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+            while (std::chrono::steady_clock::now() < until && !context.is_cancelled()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return ms;
+        });
+        registry.register_method("stats", [] {
+            return std::format("completed={} expired={} cancelled={}", rpc_stats.completed.load(),
+                               rpc_stats.expired.load(), rpc_stats.cancelled.load());
+        });
+
+        // 同机客户端可以通过 UNIX 套接字握手后改走共享内存
+        saxio::rpc::ShmServer shm_server("/tmp/saxio_rpc.sock", registry, rpc_stats);
+        if (auto shm_ret = shm_server.start(); !shm_ret) {
+            LOG_WARN("Shared memory RPC disabled: {}", shm_ret.error());
+        }
+
         auto ret = server();
         if (!ret) {
             LOG_ERROR("RPC Server error: {}", ret.error());
@@ -0,0 +1,61 @@
+#include "saxio/net/rpc/rpc_handle.hpp"
+#include "saxio/net/rpc/shm_transport.hpp"
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace saxio;
+
+//连接 UNIX 套接字但不发送 memfd，模拟卡在握手中的客户端
+int connect_silent(const std::string& path) {
+    int sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (sock >= 0 && ::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+//握手卡住的客户端不能阻塞其他客户端，也不能让 stop() 一直等待
+auto main() -> int {
+    const std::string path = "/tmp/saxio_shm_transport_test.sock";
+    rpc::ServerStats stats;
+    rpc::ShmServer server(path, rpc::default_registry(), stats);
+    if (auto ret = server.start(); !ret) {
+        std::cerr << "start failed: " << ret.error().message() << "\n";
+        return -1;
+    }
+
+    int silent = connect_silent(path);
+    if (silent < 0) {
+        std::cerr << "connect failed\n";
+        return -1;
+    }
+
+    //握手卡住期间，正常客户端仍然可以连接并调用
+    auto client = rpc::ShmClient::connect(path, 4096);
+    if (!client) {
+        std::cerr << "shm client connect failed\n";
+        return -1;
+    }
+    auto sum = (*client)->call<double>(rpc::Method::ADD, 1.5, 2.0);
+    std::cout << "add over shared memory: " << (sum ? *sum : -1) << "\n";
+    client->reset();
+
+    //再次连接后不发送数据直接停止服务器
+    int silent_again = connect_silent(path);
+    auto start = std::chrono::steady_clock::now();
+    server.stop();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "stop() with pending handshakes took " << elapsed.count() << " ms\n";
+
+    ::close(silent);
+    if (silent_again >= 0) ::close(silent_again);
+    return sum && *sum == 3.5 && elapsed < std::chrono::seconds(1) ? 0 : -1;
+}
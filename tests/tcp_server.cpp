@@ -18,14 +18,14 @@ using namespace saxio::net;
 std::atomic<bool> server_running{true};
 std::unique_ptr<ThreadPool> thread_pool;  //全局线程池
 
-void process(const std::shared_ptr<TcpStream>& stream_ptr) {
-    int client_fd = stream_ptr->fd();
+void process(TcpStream& stream) {
+    int client_fd = stream.fd();
     std::vector<char> buf(4096);
     LOG_INFO("Start processing client: {}", client_fd);
 
     while (true) {
         // 读取数据
-        auto read_result = stream_ptr->read({buf.data(), buf.size()});
+        auto read_result = stream.read({buf.data(), buf.size()});
         if (!read_result) {
             if (read_result.error().value() == 0) {
                 LOG_INFO("Client closed gracefully: {}", client_fd);
@@ -47,7 +47,7 @@ void process(const std::shared_ptr<TcpStream>& stream_ptr) {
         if (received_data.empty() ||
             (received_data.size() == 1 && received_data[0] == '\n')) {
             LOG_INFO("Received empty message from client: {}", client_fd);
-            if (!stream_ptr->write("\n")) {
+            if (!stream.write("\n")) {
                 LOG_DEBUG("Client disconnected during empty reply: {}", client_fd);
                 break;
             }
@@ -62,7 +62,7 @@ void process(const std::shared_ptr<TcpStream>& stream_ptr) {
         LOG_INFO("Response from client {} is: {}", client_fd, received_data);
 
         // 回传数据
-        auto write_result = stream_ptr->write(received_data);
+        auto write_result = stream.write(received_data);
         if (!write_result) {
             LOG_ERROR("Failed to write data back to client {}: {}",
                      client_fd, write_result.error());
@@ -72,6 +72,12 @@ void process(const std::shared_ptr<TcpStream>& stream_ptr) {
 
 }
 
+//连接处理任务：直接按值持有 TcpStream，只能移动，提交到线程池不需要额外包装
+struct ConnectionTask {
+    TcpStream stream;
+    auto operator()() -> void{ process(stream); }
+};
+
 //实现服务端完美退出
 auto signal_handler(int signal) -> void{
     if (signal == SIGINT) {
@@ -127,17 +133,12 @@ auto server() -> saxio::Result<void> {
             continue;
         }
 
-        TcpStream stream(std::move(has_stream.value()));
-        int client_fd = stream.fd();
+        ConnectionTask task{TcpStream(std::move(has_stream.value()))};
+        int client_fd = task.stream.fd();
         LOG_INFO("Connection accepted: {}", client_fd);
 
-        //使用智能指针包装流对象（因为lambda表达式无法被复制）
-        auto stream_ptr = std::make_shared<TcpStream>(std::move(stream));
-
-        //提交任务到线程池（不再创建新线程）
-        if (thread_pool->enqueue([stream_ptr]() {
-            process(stream_ptr);
-        })) {
+        //提交任务到线程池（不再创建新线程），提交失败时连接仍留在 task 中
+        if (thread_pool->enqueue(std::move(task))) {
             accepted_count++;
             LOG_INFO("Task enqueued successfully for clients {}, total accepted: {}",
                 client_fd, accepted_count);
@@ -147,7 +148,7 @@ auto server() -> saxio::Result<void> {
                 client_fd, rejected_count);
 
             //发送“服务繁忙”响应给客户端
-            auto ret = stream_ptr->write("Server busy, please try again later\n");
+            auto ret = task.stream.write("Server busy, please try again later\n");
             if (!ret) {
                 return std::unexpected{make_error(saxio::Error::kSendResponseFailed)};
             }
@@ -0,0 +1,87 @@
+#include "saxio/common/thread_pool.hpp"
+#include "saxio/common/parallel.hpp"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+
+using namespace saxio::net;
+
+// 多个生产者线程同时提交空任务，测量从开始提交到全部执行完的吞吐量
+// 队列满时生产者让出 CPU 后重试，被拒绝的次数反映背压
+double run_bench(ThreadPool::QueueMode mode, size_t producers, size_t total_tasks, size_t& rejected) {
+    std::atomic<size_t> executed{0};
+    std::atomic<size_t> rejected_count{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()), 1024, mode);
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (size_t i = p; i < total_tasks; i += producers) {
+                    while (!pool.enqueue([&] { executed.fetch_add(1, std::memory_order_relaxed); })) {
+                        rejected_count.fetch_add(1, std::memory_order_relaxed);
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    }   // 析构时等待所有任务执行完
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    rejected = rejected_count.load();
+    if (executed.load() != total_tasks) {
+        std::cerr << "执行的任务数不符: " << executed.load() << " / " << total_tasks << std::endl;
+        std::exit(-1);
+    }
+    return total_tasks / seconds;
+}
+
+// future、任务组与并行循环：结果与串行计算比较
+int run_parallel_examples() {
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()), 1024);
+
+    auto answer = pool.submit([] { return 6 * 7; });
+
+    std::vector<double> values(1 << 20);
+    std::iota(values.begin(), values.end(), 0.0);
+    parallel_for(pool, 0, values.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) values[i] *= 0.5;
+    }, 4096);
+    double sum = parallel_reduce(pool, 0, values.size(), 0.0, [&](size_t first, size_t last) {
+        return std::accumulate(values.begin() + first, values.begin() + last, 0.0);
+    }, [](double a, double b) { return a + b; }, 4096);
+
+    std::atomic<size_t> groups_done{0};
+    {
+        TaskGroup group(pool);
+        for (int i = 0; i < 16; ++i) {
+            group.run([&] { groups_done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        group.wait();
+    }
+
+    double expected = 0.5 * (values.size() - 1.0) * values.size() / 2;
+    std::cout << "submit: " << answer.get() << ", parallel_reduce: " << sum << " (期望 " << expected
+              << "), 任务组完成 " << groups_done.load() << " 个任务" << std::endl;
+    return sum == expected && groups_done.load() == 16 ? 0 : -1;
+}
+
+// thread_pool [任务数]
+auto main(int argc, char* argv[]) -> int {
+    size_t total_tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    std::cout << "生产者  互斥锁队列(任务/s)  无锁队列(任务/s)" << std::endl;
+    for (size_t producers : {1, 4, 16, 64}) {
+        size_t mutex_rejected = 0, ring_rejected = 0;
+        double mutex_rate = run_bench(ThreadPool::QueueMode::kMutex, producers, total_tasks, mutex_rejected);
+        double ring_rate = run_bench(ThreadPool::QueueMode::kLockFree, producers, total_tasks, ring_rejected);
+        std::cout << producers << "\t" << static_cast<size_t>(mutex_rate) << " (拒绝 " << mutex_rejected << ")\t"
+                  << static_cast<size_t>(ring_rate) << " (拒绝 " << ring_rejected << ")" << std::endl;
+    }
+    return run_parallel_examples();
+}